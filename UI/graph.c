@@ -0,0 +1,292 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <stdint.h>
+
+#include "graph.h"
+#include "graph_expr.h"
+#include "ui.h"
+#include "tinyexpr/tinyexpr.h"
+
+#define JOIN_DEPTH  5       // halvings of a column gap looking for a discontinuity
+
+typedef struct {
+    char expr[INPUT_BUFFER_SIZE];       // "": nothing worked out yet
+    int ox;                             // column sx was at (sx - ox) * step
+    double step;
+    bool adaptive;
+    float y[GRAPH_COLS];
+    uint8_t undefined[GRAPH_COLS / 8];  // NaN or infinite there
+    uint8_t approx[GRAPH_COLS / 8];     // not evaluated in double: only known to be in that row,
+                                        // or within half a row of it
+    uint8_t broken[GRAPH_COLS / 8];     // not joined to the column before
+    uint32_t points[GRAPH_BACKENDS];    // evaluations since expr was set
+    uint32_t bounds;
+} curve_t;
+
+// Column sx shows x = (sx - view_ox) * view_step and row sy y = (view_oy - sy) * view_step,
+// so x = 0 and y = 0 are at view_ox, view_oy, on the screen or not. The step is always a
+// power of two, which keeps the columns of one zoom exactly on those of the next.
+static int view_ox = GRAPH_ORIGIN_X, view_oy = GRAPH_ORIGIN_Y, view_zoom = 0;
+static double view_step = 1.0 / GRAPH_SCALE;
+static bool adaptive = true;
+
+static curve_t curves[GRAPH_CURVES];
+static curve_t old;
+static uint8_t gap_unknown[GRAPH_COLS / 8];
+
+// what the curve being worked out is evaluated with: prog if it compiled, else te
+static graph_expr_t prog;
+static bool use_prog;
+static te_expr *te;
+static double x_val;
+
+static bool bit(const uint8_t *m, int i) { return m[i >> 3] & 1 << (i & 7); }
+
+static void put(uint8_t *m, int i, bool v) {
+    if (v) m[i >> 3] |= 1 << (i & 7);
+    else m[i >> 3] &= ~(1 << (i & 7));
+}
+
+static double col_x(int sx) { return (sx - view_ox) * view_step; }
+
+// the row of y counted from y = 0, as curve_row() takes it
+static int level(double y) {
+    float v = (float) y * (float) (1.0 / view_step);
+    return v > 1e6f ? 1000000 : v < -1e6f ? -1000000 : (int) v;
+}
+
+// The quickest backend whose bound over the columns being evaluated keeps it within
+// half a row of double. Fixed point and float are both well ahead of software double
+// on the RP2040; with no FPU fixed point is ahead of float too.
+static int backend(graph_bound_t r) {
+    if (!r.cont) return GRAPH_DOUBLE;
+    for (int k = GRAPH_BACKENDS - 1; k > GRAPH_DOUBLE; k--) {
+        if (r.err[k] < view_step / 2) return k;
+    }
+    return GRAPH_DOUBLE;
+}
+
+static void sample(curve_t *c, int sx, int k) {
+    x_val = col_x(sx);
+    double yv;
+    if (!use_prog) yv = te_eval(te);
+    else if (k == GRAPH_FIXED) yv = graph_expr_evalq(&prog, x_val);
+    else if (k == GRAPH_FLOAT) yv = graph_expr_evalf(&prog, x_val);
+    else yv = graph_expr_eval(&prog, x_val);
+    c->points[k]++;
+    put(c->undefined, sx, isnan(yv) || isinf(yv));
+    put(c->approx, sx, k != GRAPH_DOUBLE);
+    c->y[sx] = yv;
+}
+
+static graph_bound_t bound(curve_t *c, double x0, double x1) {
+    c->bounds++;
+    return graph_expr_bound(&prog, x0, x1);
+}
+
+// whether the curve is continuous from x0 to x1, halving the range where the bounds
+// are not sure until a piece is too small to bother with
+static bool joins(curve_t *c, double x0, double x1, int depth) {
+    if (bound(c, x0, x1).cont) return true;
+    if (!depth) return false;
+    double m = (x0 + x1) / 2;
+    return joins(c, x0, m, depth - 1) && joins(c, m, x1, depth - 1);
+}
+
+// whether column sx is to be drawn apart from the one before; only worth finding out
+// where both are there and joining them would draw more than they do
+static bool apart(curve_t *c, int sx) {
+    if (sx == 0 || bit(c->undefined, sx) || bit(c->undefined, sx - 1)) return false;
+    if (abs(level(c->y[sx]) - level(c->y[sx - 1])) <= 1) return false;
+    return !joins(c, col_x(sx - 1), col_x(sx), JOIN_DEPTH);
+}
+
+// Columns a..b, and whether a joins the column before, from the bounds over that
+// stretch. Where they fit in one row nothing is evaluated; where they are no more
+// than half as many rows as columns there may be such flat stretches inside, so the
+// halves are looked at on their own; steeper than that every column is evaluated.
+static void fill(curve_t *c, int a, int b) {
+    graph_bound_t r = bound(c, col_x(a > 0 ? a - 1 : a), col_x(b));
+    int rows = r.cont ? level(r.hi) - level(r.lo) : 0;
+    if (r.none) {
+        for (int sx = a; sx <= b; sx++) {
+            put(c->undefined, sx, true);
+            put(c->approx, sx, false);
+            put(c->broken, sx, false);
+        }
+        return;
+    }
+    if (r.cont && rows == 0) {
+        float mid = (r.lo + r.hi) / 2;
+        for (int sx = a; sx <= b; sx++) {
+            c->y[sx] = mid;
+            put(c->undefined, sx, false);
+            put(c->approx, sx, true);
+            put(c->broken, sx, false);
+        }
+        return;
+    }
+    if (a == b) {
+        sample(c, a, backend(r));
+        put(c->broken, a, !r.cont && apart(c, a));
+        return;
+    }
+    if (r.cont && (b - a < 2 || rows * 2 > b - a + 1)) {
+        int k = backend(r);
+        for (int sx = a; sx <= b; sx++) {
+            sample(c, sx, k);
+            put(c->broken, sx, false);
+        }
+        return;
+    }
+    int m = (a + b) / 2;
+    fill(c, a, m);
+    fill(c, m + 1, b);
+}
+
+static bool curve_current(const curve_t *c, const char *expr) {
+    return c->expr[0] && c->ox == view_ox && c->step == view_step && c->adaptive == adaptive &&
+           !strcmp(c->expr, expr);
+}
+
+bool graph_set(int n, const char *expr) {
+    curve_t *c = &curves[n];
+    if (curve_current(c, expr)) return true;
+    // a function kept with F6 is usually the one just entered
+    for (int i = 0; i < GRAPH_CURVES; i++) {
+        if (i != n && curve_current(&curves[i], expr)) {
+            *c = curves[i];
+            return true;
+        }
+    }
+    use_prog = graph_expr_compile(&prog, expr);
+    te_variable vars[] = {{"x", &x_val}};
+    te = use_prog ? NULL : te_compile(expr, vars, 1, 0);
+    if (!use_prog && !te) {
+        c->expr[0] = '\0';
+        return false;
+    }
+    // the same function in another view keeps the columns landing on the new ones;
+    // zooming in, only those it evaluated in double, as the rest may be out by a row
+    bool keep = c->expr[0] && c->adaptive == adaptive && !strcmp(c->expr, expr);
+    bool pan = keep && c->step == view_step;
+    bool exact = keep && c->step > view_step;
+    if (keep) old = *c;
+    else {
+        strncpy(c->expr, expr, INPUT_BUFFER_SIZE - 1);
+        memset(c->points, 0, sizeof(c->points));
+        c->bounds = 0;
+    }
+    c->ox = view_ox;
+    c->step = view_step;
+    c->adaptive = adaptive;
+    bool sampled = use_prog && adaptive;
+    // every column: one backend for all of them
+    int whole = use_prog && !adaptive ? backend(bound(c, col_x(0), col_x(GRAPH_COLS - 1))) : GRAPH_DOUBLE;
+    double ratio = keep ? view_step / old.step : 0;
+    int run = -1;       // first column of the stretch to be worked out
+    for (int sx = 0; sx <= GRAPH_COLS; sx++) {
+        if (sx < GRAPH_COLS && keep) {
+            double at = old.ox + (sx - view_ox) * ratio;
+            int o = (int) at;
+            if (at >= 0 && at < GRAPH_COLS && at == o && (!exact || !bit(old.approx, o))) {
+                c->y[sx] = old.y[o];
+                put(c->undefined, sx, bit(old.undefined, o));
+                put(c->approx, sx, bit(old.approx, o));
+                put(c->broken, sx, bit(old.broken, o));
+                // the gap before it is the same one only if the column before came along
+                put(gap_unknown, sx, !pan || o == 0);
+                if (run >= 0) {
+                    if (sampled) fill(c, run, sx - 1);
+                    else for (int i = run; i < sx; i++) sample(c, i, whole);
+                    run = -1;
+                }
+                continue;
+            }
+        }
+        if (sx == GRAPH_COLS) break;
+        put(gap_unknown, sx, false);
+        if (!sampled) put(c->broken, sx, false);
+        if (run < 0) run = sx;
+    }
+    if (run >= 0) {
+        if (sampled) fill(c, run, GRAPH_COLS - 1);
+        else for (int i = run; i < GRAPH_COLS; i++) sample(c, i, whole);
+    }
+    for (int sx = 0; sx < GRAPH_COLS; sx++) {
+        if (!bit(gap_unknown, sx)) continue;
+        put(c->broken, sx, sampled && apart(c, sx));
+    }
+    if (te) te_free(te);
+    te = NULL;
+    return true;
+}
+
+void graph_forget(int n) {
+    curves[n].expr[0] = '\0';
+}
+
+void graph_stats(int n, uint32_t points[GRAPH_BACKENDS], uint32_t *bounds) {
+    memcpy(points, curves[n].points, sizeof(curves[n].points));
+    *bounds = curves[n].bounds;
+}
+
+void graph_set_adaptive(bool on) { adaptive = on; }
+
+bool graph_adaptive(void) { return adaptive; }
+
+void graph_pan(int dx, int dy) {
+    view_ox -= dx;
+    view_oy += dy;
+}
+
+bool graph_zoom(bool in) {
+    if (in ? view_zoom == GRAPH_ZOOM_MAX : view_zoom == -GRAPH_ZOOM_MAX) return false;
+    view_zoom += in ? 1 : -1;
+    view_step = ldexp(1.0 / GRAPH_SCALE, -view_zoom);
+    // the middle of the plot stays where it is, within half a pixel zooming out
+    if (in) {
+        view_ox = GRAPH_ORIGIN_X - (GRAPH_ORIGIN_X - view_ox) * 2;
+        view_oy = GRAPH_ORIGIN_Y - (GRAPH_ORIGIN_Y - view_oy) * 2;
+    } else {
+        view_ox = GRAPH_ORIGIN_X - (GRAPH_ORIGIN_X - view_ox) / 2;
+        view_oy = GRAPH_ORIGIN_Y - (GRAPH_ORIGIN_Y - view_oy) / 2;
+    }
+    return true;
+}
+
+void graph_draw_axes(void) {
+    if (view_oy >= GRAPH_TOP && view_oy <= GRAPH_BOTTOM) draw_hline(0, GRAPH_COLS - 1, view_oy, GRAY);
+    if (view_ox >= 0 && view_ox < GRAPH_COLS) draw_vline(view_ox, GRAPH_TOP, GRAPH_BOTTOM, GRAY);
+}
+
+// screen row of column sx, -1 where there is none
+static int curve_row(const curve_t *c, int sx) {
+    if (bit(c->undefined, sx)) return -1;
+    float v = c->y[sx] * (float) (1.0 / view_step);
+    if (fabsf(v) > 1e6f) return -1;
+    return view_oy - (int) v;
+}
+
+void graph_draw(int n, int colour) {
+    const curve_t *c = &curves[n];
+    if (!c->expr[0]) return;
+    // flat stretches go out as one hline, steps as one vline joining the previous point
+    int last_sy = -1, run_x = -1, run_y = 0, sx;
+    for (sx = 0; sx < GRAPH_COLS; sx++) {
+        int sy = curve_row(c, sx);
+        if (sy < GRAPH_TOP || sy > GRAPH_BOTTOM || bit(c->broken, sx)) {
+            if (run_x != -1) draw_hline(run_x, sx - 1, run_y, colour);
+            run_x = last_sy = -1;
+            if (sy < GRAPH_TOP || sy > GRAPH_BOTTOM) continue;
+        }
+        if (run_x != -1 && sy == run_y) { last_sy = sy; continue; }
+        if (run_x != -1) draw_hline(run_x, sx - 1, run_y, colour);
+        run_x = -1;
+        if (last_sy == -1 || last_sy == sy) { run_x = sx; run_y = sy; }
+        else draw_vline(sx, last_sy, sy, colour);
+        last_sy = sy;
+    }
+    if (run_x != -1) draw_hline(run_x, sx - 1, run_y, colour);
+}
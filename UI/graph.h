@@ -0,0 +1,54 @@
+#ifndef COYOTE_GRAPH_H
+#define COYOTE_GRAPH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "lcdspi.h"
+#include "graph_expr.h"
+
+// Function plots for the graph tab. Each curve keeps the y of every screen column,
+// worked out for the expression and viewport it was last given, so drawing it again
+// (the tab comes back, another curve is added) is only rasterising. The expression
+// is evaluated again only when it or the viewport changes, and then only at the
+// columns the curve does not already have: a pan shifts the samples along and
+// evaluates the columns it brings in, a zoom keeps those landing on the new grid.
+// Moving up and down needs no evaluation at all.
+//
+// Sampled adaptively (the default), a curve is worked out from bounds over stretches
+// of columns (graph_expr.h): a stretch whose bounds fit in one row is not evaluated,
+// and a gap between columns the bounds cannot show to be continuous is halved until
+// they can or it is clear there is a discontinuity there, which is then not joined.
+// Otherwise every column is evaluated and joined to the one before, as tinyexpr
+// curves always are.
+//
+// Each stretch of columns is evaluated with the quickest backend (graph_expr.h) whose
+// error bound there is under half a pixel at the current zoom; every column at a
+// time, one backend does for the whole screen. Calculator results stay in double.
+
+#define GRAPH_COLS      LCD_WIDTH
+#define GRAPH_CURVES    5       // the functions kept with F6, then the last one entered
+#define GRAPH_TOP       14
+#define GRAPH_BOTTOM    294
+#define GRAPH_ORIGIN_X  160     // where x = 0 and y = 0 start out, and what zooming keeps still
+#define GRAPH_ORIGIN_Y  154
+#define GRAPH_SCALE     16      // pixels a unit to start with
+#define GRAPH_ZOOM_MAX  8       // steps of two either way
+
+// curve n shows expr from now on; false if expr does not compile
+extern bool graph_set(int n, const char *expr);
+extern void graph_draw_axes(void);
+extern void graph_draw(int n, int colour);
+// drops what curve n has worked out
+extern void graph_forget(int n);
+// moves the view dx pixels right and dy pixels up
+extern void graph_pan(int dx, int dy);
+// twice (in) or half as many pixels a unit; false at the limit
+extern bool graph_zoom(bool in);
+extern void graph_set_adaptive(bool on);
+extern bool graph_adaptive(void);
+// points evaluated with each backend and bounds worked out for curve n since it was
+// given its expression
+extern void graph_stats(int n, uint32_t points[GRAPH_BACKENDS], uint32_t *bounds);
+
+#endif
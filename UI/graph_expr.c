@@ -0,0 +1,585 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+
+#include "graph_expr.h"
+
+#define PI  3.14159265358979323846
+
+#define FLOAT_ROUND     (1.0 / (1 << 24))   // one rounding, relative: half an ulp
+#define FLOAT_FN        (1.0 / (1 << 22))   // a library function, taken to be within 2 ulp
+#define FLOAT_TINY      1e-44               // denormals round by as much as this
+#define FLOAT_TRIG_MAX  128.0               // sinf and co. are not trusted to reduce further out
+
+#define FIXED_ONE       65536
+#define FIXED_ULP       (1.0 / FIXED_ONE)
+#define FIXED_MAX       32767.0
+#define FIXED_2PI       ((int32_t) (2 * PI * FIXED_ONE + 0.5))
+#define FIXED_HALF_PI   ((int32_t) (PI / 2 * FIXED_ONE + 0.5))
+#define FIXED_STEPS     ((int32_t) (512 / PI * FIXED_ONE + 0.5))    // sine table steps a radian
+#define FIXED_SIN_ERR   (3 * FIXED_ULP)     // the table, its interpolation and rounding
+
+enum {
+    OP_NUM, OP_X, OP_NEG,
+    OP_ADD, OP_SUB, OP_MUL, OP_DIV, OP_MOD, OP_POW, OP_ATAN2,
+    OP_ABS, OP_ACOS, OP_ASIN, OP_ATAN, OP_CEIL, OP_COS, OP_COSH, OP_EXP, OP_FLOOR,
+    OP_LN, OP_LOG10, OP_SIN, OP_SINH, OP_SQRT, OP_TAN, OP_TANH,
+};
+
+static double (*const unary[])(double) = {
+    fabs, acos, asin, atan, ceil, cos, cosh, exp, floor, log, log10, sin, sinh, sqrt, tan, tanh,
+};
+
+static float (*const unaryf[])(float) = {
+    fabsf, acosf, asinf, atanf, ceilf, cosf, coshf, expf, floorf, logf, log10f, sinf, sinhf, sqrtf, tanf, tanhf,
+};
+
+// tinyexpr's built-in names; arity 0 is a constant
+static const struct {
+    const char *name;
+    uint8_t op, arity;
+    double value;
+} names[] = {
+    {"abs", OP_ABS, 1}, {"acos", OP_ACOS, 1}, {"asin", OP_ASIN, 1}, {"atan", OP_ATAN, 1},
+    {"atan2", OP_ATAN2, 2}, {"ceil", OP_CEIL, 1}, {"cos", OP_COS, 1}, {"cosh", OP_COSH, 1},
+    {"e", OP_NUM, 0, 2.71828182845904523536}, {"exp", OP_EXP, 1}, {"floor", OP_FLOOR, 1},
+    {"ln", OP_LN, 1}, {"log", OP_LOG10, 1}, {"log10", OP_LOG10, 1}, {"pi", OP_NUM, 0, PI},
+    {"pow", OP_POW, 2}, {"sin", OP_SIN, 1}, {"sinh", OP_SINH, 1}, {"sqrt", OP_SQRT, 1},
+    {"tan", OP_TAN, 1}, {"tanh", OP_TANH, 1},
+};
+
+typedef struct {
+    graph_expr_t *p;
+    const char *s;
+    int depth, max_depth, nums;
+    bool err;
+} parser_t;
+
+static void emit(parser_t *ps, int op) {
+    if (ps->p->n == GRAPH_EXPR_OPS) {
+        ps->err = true;
+        return;
+    }
+    ps->p->op[ps->p->n++] = op;
+    // numbers and x push, binary operators take two and push one, the rest take one
+    if (op <= OP_X) ps->depth++;
+    else if (op >= OP_ADD && op <= OP_ATAN2) ps->depth--;
+    if (ps->depth > ps->max_depth) ps->max_depth = ps->depth;
+}
+
+static void emit_num(parser_t *ps, double v) {
+    if (ps->nums == GRAPH_EXPR_NUMS) {
+        ps->err = true;
+        return;
+    }
+    ps->p->numf[ps->nums] = (float) v;
+    ps->p->numq[ps->nums] = fabs(v) < FIXED_MAX ? (int32_t) lround(v * FIXED_ONE) : 0;
+    ps->p->num[ps->nums++] = v;
+    emit(ps, OP_NUM);
+}
+
+static void ws(parser_t *ps) {
+    while (*ps->s == ' ' || *ps->s == '\t' || *ps->s == '\n' || *ps->s == '\r') ps->s++;
+}
+
+static bool take(parser_t *ps, char c) {
+    ws(ps);
+    if (*ps->s != c) return false;
+    ps->s++;
+    return true;
+}
+
+static void expr(parser_t *ps);
+static void power(parser_t *ps);
+
+static void base(parser_t *ps) {
+    ws(ps);
+    const char *p = ps->s;
+    if ((*p >= '0' && *p <= '9') || *p == '.') {
+        char *end;
+        emit_num(ps, strtod(p, &end));
+        ps->s = end;
+    } else if (*p >= 'a' && *p <= 'z') {
+        const char *q = p;
+        while ((*q >= 'a' && *q <= 'z') || (*q >= '0' && *q <= '9') || *q == '_') q++;
+        ps->s = q;
+        if (q - p == 1 && *p == 'x') {
+            emit(ps, OP_X);
+            return;
+        }
+        for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+            if (strlen(names[i].name) != (size_t) (q - p) || strncmp(names[i].name, p, q - p)) continue;
+            if (names[i].arity == 0) {
+                if (take(ps, '(') && !take(ps, ')')) ps->err = true;
+                emit_num(ps, names[i].value);
+            } else if (names[i].arity == 1) {
+                power(ps);
+                emit(ps, names[i].op);
+            } else {
+                if (!take(ps, '(')) ps->err = true;
+                expr(ps);
+                if (!take(ps, ',')) ps->err = true;
+                expr(ps);
+                if (!take(ps, ')')) ps->err = true;
+                emit(ps, names[i].op);
+            }
+            return;
+        }
+        ps->err = true;
+    } else if (take(ps, '(')) {
+        expr(ps);
+        if (!take(ps, ')')) ps->err = true;
+    } else {
+        ps->err = true;
+    }
+}
+
+static void power(parser_t *ps) {
+    bool neg = false;
+    ws(ps);
+    while (*ps->s == '-' || *ps->s == '+') {
+        if (*ps->s == '-') neg = !neg;
+        ps->s++;
+        ws(ps);
+    }
+    base(ps);
+    if (neg) emit(ps, OP_NEG);
+}
+
+static void factor(parser_t *ps) {
+    power(ps);
+    while (!ps->err && take(ps, '^')) {
+        power(ps);
+        emit(ps, OP_POW);
+    }
+}
+
+static void term(parser_t *ps) {
+    factor(ps);
+    while (!ps->err) {
+        ws(ps);
+        char c = *ps->s;
+        if (c != '*' && c != '/' && c != '%') break;
+        ps->s++;
+        factor(ps);
+        emit(ps, c == '*' ? OP_MUL : c == '/' ? OP_DIV : OP_MOD);
+    }
+}
+
+static void expr(parser_t *ps) {
+    term(ps);
+    while (!ps->err) {
+        ws(ps);
+        char c = *ps->s;
+        if (c != '+' && c != '-') break;
+        ps->s++;
+        term(ps);
+        emit(ps, c == '+' ? OP_ADD : OP_SUB);
+    }
+}
+
+bool graph_expr_compile(graph_expr_t *p, const char *s) {
+    parser_t ps = {p, s, 0, 0, 0, false};
+    p->n = 0;
+    expr(&ps);
+    ws(&ps);
+    return !ps.err && !*ps.s && ps.max_depth <= GRAPH_EXPR_STACK;
+}
+
+double graph_expr_eval(const graph_expr_t *p, double x) {
+    double st[GRAPH_EXPR_STACK];
+    const double *num = p->num;
+    int sp = 0;
+    for (int i = 0; i < p->n; i++) {
+        int op = p->op[i];
+        if (op == OP_NUM) st[sp++] = *num++;
+        else if (op == OP_X) st[sp++] = x;
+        else if (op == OP_NEG) st[sp - 1] = -st[sp - 1];
+        else if (op >= OP_ABS) st[sp - 1] = unary[op - OP_ABS](st[sp - 1]);
+        else {
+            double a = st[sp - 2], b = st[sp - 1], r;
+            switch (op) {
+                case OP_ADD: r = a + b; break;
+                case OP_SUB: r = a - b; break;
+                case OP_MUL: r = a * b; break;
+                case OP_DIV: r = a / b; break;
+                case OP_MOD: r = fmod(a, b); break;
+                case OP_POW: r = pow(a, b); break;
+                default: r = atan2(a, b); break;
+            }
+            st[--sp - 1] = r;
+        }
+    }
+    return st[0];
+}
+
+double graph_expr_evalf(const graph_expr_t *p, double x) {
+    float st[GRAPH_EXPR_STACK];
+    const float *num = p->numf;
+    int sp = 0;
+    for (int i = 0; i < p->n; i++) {
+        int op = p->op[i];
+        if (op == OP_NUM) st[sp++] = *num++;
+        else if (op == OP_X) st[sp++] = (float) x;
+        else if (op == OP_NEG) st[sp - 1] = -st[sp - 1];
+        else if (op >= OP_ABS) st[sp - 1] = unaryf[op - OP_ABS](st[sp - 1]);
+        else {
+            float a = st[sp - 2], b = st[sp - 1], r;
+            switch (op) {
+                case OP_ADD: r = a + b; break;
+                case OP_SUB: r = a - b; break;
+                case OP_MUL: r = a * b; break;
+                case OP_DIV: r = a / b; break;
+                case OP_MOD: r = fmodf(a, b); break;
+                case OP_POW: r = powf(a, b); break;
+                default: r = atan2f(a, b); break;
+            }
+            st[--sp - 1] = r;
+        }
+    }
+    return st[0];
+}
+
+// Fixed point. Products and quotients go through 64 bits and truncate; sums wrap
+// (the bounds keep the backend away from where they would); sin and cos interpolate
+// a quarter-wave table.
+
+static int32_t sin_table[257];      // sin(i * pi / 512)
+
+static int32_t fixed_sin(int32_t x) {
+    if (!sin_table[256]) {
+        for (int i = 0; i <= 256; i++) sin_table[i] = (int32_t) lround(sin(i * PI / 512) * FIXED_ONE);
+    }
+    int32_t t = x % FIXED_2PI;
+    if (t < 0) t += FIXED_2PI;
+    // in table steps, 1024 to a turn
+    int32_t pos = (int32_t) (((int64_t) t * FIXED_STEPS) >> 16);
+    int n = (pos >> 16) & 1023, k = n & 255, f = pos & 0xFFFF;
+    int32_t a, b;
+    if (n & 256) {
+        a = sin_table[256 - k];
+        b = sin_table[255 - k];
+    } else {
+        a = sin_table[k];
+        b = sin_table[k + 1];
+    }
+    int32_t v = a + (int32_t) (((int64_t) (b - a) * f) >> 16);
+    return n & 512 ? -v : v;
+}
+
+static uint32_t fixed_isqrt(uint64_t v) {
+    uint64_t r = 0, bit = (uint64_t) 1 << 62;
+    while (bit > v) bit >>= 2;
+    while (bit) {
+        if (v >= r + bit) {
+            v -= r + bit;
+            r = (r >> 1) + bit;
+        } else {
+            r >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint32_t) r;
+}
+
+double graph_expr_evalq(const graph_expr_t *p, double x) {
+    if (!(fabs(x) < FIXED_MAX)) return NAN;
+    int32_t st[GRAPH_EXPR_STACK], xq = (int32_t) lround(x * FIXED_ONE);
+    const int32_t *num = p->numq;
+    bool bad = false;
+    int sp = 0;
+    for (int i = 0; i < p->n; i++) {
+        int op = p->op[i];
+        if (op == OP_NUM) st[sp++] = *num++;
+        else if (op == OP_X) st[sp++] = xq;
+        else if (op < OP_ADD || op >= OP_ABS) {
+            int32_t *a = &st[sp - 1];
+            switch (op) {
+                case OP_NEG: *a = (int32_t) (0u - (uint32_t) *a); break;
+                case OP_ABS: if (*a < 0) *a = (int32_t) (0u - (uint32_t) *a); break;
+                case OP_FLOOR: *a &= ~0xFFFF; break;
+                case OP_CEIL: *a = (int32_t) (0u - ((0u - (uint32_t) *a) & ~0xFFFFu)); break;
+                case OP_SQRT:
+                    if (*a < 0) bad = true;
+                    else *a = (int32_t) fixed_isqrt((uint64_t) *a << 16);
+                    break;
+                case OP_SIN: *a = fixed_sin(*a); break;
+                case OP_COS: *a = fixed_sin((int32_t) ((uint32_t) *a + FIXED_HALF_PI)); break;
+                default: bad = true; break;
+            }
+        } else {
+            int32_t a = st[sp - 2], b = st[sp - 1], r = 0;
+            switch (op) {
+                case OP_ADD: r = (int32_t) ((uint32_t) a + (uint32_t) b); break;
+                case OP_SUB: r = (int32_t) ((uint32_t) a - (uint32_t) b); break;
+                case OP_MUL: r = (int32_t) (((int64_t) a * b) >> 16); break;
+                case OP_DIV:
+                    if (b) r = (int32_t) ((int64_t) a * FIXED_ONE / b);
+                    else bad = true;
+                    break;
+                case OP_POW:
+                    // whole powers only, by multiplying
+                    if ((b & 0xFFFF) || b < 0 || b > GRAPH_EXPR_FIXED_POW * FIXED_ONE) bad = true;
+                    else for (r = FIXED_ONE; b > 0; b -= FIXED_ONE) r = (int32_t) (((int64_t) r * a) >> 16);
+                    break;
+                default: bad = true; break;
+            }
+            st[--sp - 1] = r;
+        }
+    }
+    return bad ? NAN : st[0] * FIXED_ULP;
+}
+
+// Bounds. Every operator takes the ranges of its operands to one its result is sure
+// to stay within, and says whether it is continuous there; anything it cannot be
+// sure of (a division by a range holding 0, a pole of tan, a step of floor) gives up.
+
+static const graph_bound_t unknown = {0, 0, false, false};
+static const graph_bound_t nowhere = {0, 0, false, true};
+
+static graph_bound_t span(double a, double b) {
+    return (graph_bound_t) {fmin(a, b), fmax(a, b), isfinite(a) && isfinite(b), false};
+}
+
+static graph_bound_t corners(double (*f)(double, double), graph_bound_t a, graph_bound_t b) {
+    graph_bound_t r = span(f(a.lo, b.lo), f(a.hi, b.hi)), s = span(f(a.lo, b.hi), f(a.hi, b.lo));
+    return (graph_bound_t) {fmin(r.lo, s.lo), fmax(r.hi, s.hi), r.cont && s.cont, false};
+}
+
+static double mul(double a, double b) { return a * b; }
+static double dv(double a, double b) { return a / b; }
+
+// whether lo..hi holds at + k * period for some k
+static bool holds(double lo, double hi, double at, double period) {
+    return ceil((lo - at) / period) <= floor((hi - at) / period);
+}
+
+// sin or cos, from the ends and the peaks and troughs in between
+static graph_bound_t wave(double (*f)(double), double peak, graph_bound_t a) {
+    if (a.hi - a.lo >= 2 * PI) return (graph_bound_t) {-1, 1, true, false};
+    graph_bound_t r = span(f(a.lo), f(a.hi));
+    if (holds(a.lo, a.hi, peak, 2 * PI)) r.hi = 1;
+    if (holds(a.lo, a.hi, peak + PI, 2 * PI)) r.lo = -1;
+    return r;
+}
+
+static graph_bound_t bound_pow(graph_bound_t a, graph_bound_t b) {
+    if (b.lo == b.hi && b.lo == floor(b.lo)) {
+        double n = b.lo;
+        bool zero = a.lo <= 0 && a.hi >= 0;
+        if (n < 0 && zero) return unknown;
+        graph_bound_t r = span(pow(a.lo, n), pow(a.hi, n));
+        // even powers turn at 0
+        if (n > 0 && zero && fmod(n, 2) == 0) r.lo = 0;
+        return r;
+    }
+    if (a.hi < 0 && b.lo == b.hi) return nowhere;
+    if (a.lo < 0 || (a.lo == 0 && b.lo <= 0)) return unknown;
+    return corners(pow, a, b);
+}
+
+static graph_bound_t bound_mod(graph_bound_t a, graph_bound_t b) {
+    if (b.lo != b.hi || b.lo == 0) return unknown;
+    double k = trunc(a.lo / b.lo);
+    if (trunc(a.hi / b.lo) != k) return unknown;
+    return span(a.lo - k * b.lo, a.hi - k * b.lo);
+}
+
+static graph_bound_t bound_atan2(graph_bound_t a, graph_bound_t b) {
+    // away from the cut along the negative x axis
+    if (b.lo > 0 || (b.hi < 0 && (a.lo > 0 || a.hi < 0))) return corners(atan2, a, b);
+    return unknown;
+}
+
+static graph_bound_t bound_unary(int op, graph_bound_t a) {
+    bool zero = a.lo <= 0 && a.hi >= 0;
+    switch (op) {
+        case OP_ABS:
+            if (zero) return span(0, fmax(-a.lo, a.hi));
+            return span(fabs(a.lo), fabs(a.hi));
+        case OP_COSH:
+            if (zero) return span(1, fmax(cosh(a.lo), cosh(a.hi)));
+            return span(cosh(a.lo), cosh(a.hi));
+        case OP_ACOS:
+        case OP_ASIN:
+            if (a.lo > 1 || a.hi < -1) return nowhere;
+            if (a.lo < -1 || a.hi > 1) return unknown;
+            break;
+        case OP_LN:
+        case OP_LOG10:
+            if (a.hi < 0) return nowhere;
+            if (a.lo <= 0) return unknown;
+            break;
+        case OP_SQRT:
+            if (a.hi < 0) return nowhere;
+            if (a.lo < 0) return unknown;
+            break;
+        case OP_CEIL:
+        case OP_FLOOR:
+            // a step is a gap
+            if (unary[op - OP_ABS](a.lo) != unary[op - OP_ABS](a.hi)) return unknown;
+            break;
+        case OP_SIN: return wave(sin, PI / 2, a);
+        case OP_COS: return wave(cos, 0, a);
+        case OP_TAN:
+            if (holds(a.lo, a.hi, PI / 2, PI)) return unknown;
+            break;
+    }
+    // the rest are monotonic where they are defined
+    return span(unary[op - OP_ABS](a.lo), unary[op - OP_ABS](a.hi));
+}
+
+// Errors. Each operator adds its own rounding to what its operands were off by, as
+// far as its slope over the operands' ranges (widened by those errors) can carry it.
+
+static double mag(const graph_bound_t *v) { return fmax(fabs(v->lo), fabs(v->hi)); }
+
+static double pow_err(int k, const graph_bound_t *a, const graph_bound_t *b, const graph_bound_t *r) {
+    bool fl = k == GRAPH_FLOAT;
+    double ea = a->err[k], eb = b->err[k];
+    double lo = a->lo - ea, hi = a->hi + ea, far = fmax(-lo, hi);
+    if (b->lo == b->hi && eb == 0 && b->lo == floor(b->lo)) {
+        // a whole power: the slope n x^(n - 1) is steepest furthest from 0, or for n < 0 nearest
+        double n = b->lo, e;
+        if (n == 0) return 0;
+        if (!fl && (n < 0 || n > GRAPH_EXPR_FIXED_POW)) return INFINITY;
+        if (n > 0) {
+            e = n * pow(far, n - 1) * ea;
+        } else {
+            double near = lo > 0 ? lo : hi < 0 ? -hi : 0;
+            if (near == 0) return INFINITY;
+            e = -n * pow(near, n - 1) * ea;
+        }
+        // powf may well be expf(y logf x), off by as much as y log x is
+        if (fl) return e + FLOAT_FN * mag(r) * (1 + fabs(n * log(fmax(far, 1)))) + FLOAT_TINY;
+        // n - 1 multiplications, each up to an ulp out, and grown by the ones after it
+        return e + (n - 1) * FIXED_ULP * pow(fmax(far, 1), n - 1);
+    }
+    if (!fl || lo <= 0) return INFINITY;
+    // the slopes y x^(y - 1) and x^y ln x are steepest at corners
+    double blo = b->lo - eb, bhi = b->hi + eb, y = fmax(fabs(blo), fabs(bhi));
+    double l = fmax(fabs(log(lo)), fabs(log(hi)));
+    double s = fmax(fmax(pow(lo, blo - 1), pow(lo, bhi - 1)), fmax(pow(hi, blo - 1), pow(hi, bhi - 1)));
+    double v = fmax(fmax(pow(lo, blo), pow(lo, bhi)), fmax(pow(hi, blo), pow(hi, bhi)));
+    return y * s * ea + l * v * eb + FLOAT_FN * mag(r) * (1 + y * l) + FLOAT_TINY;
+}
+
+static double op_err(int k, int op, const graph_bound_t *a, const graph_bound_t *b, const graph_bound_t *r) {
+    bool fl = k == GRAPH_FLOAT;
+    double ea = a->err[k], eb = b->err[k], m = mag(r);
+    // one rounding of the result; a library function, of which fixed point has few
+    double round = fl ? FLOAT_ROUND * m + FLOAT_TINY : FIXED_ULP;
+    double fn = fl ? FLOAT_FN * m + FLOAT_TINY : INFINITY;
+    // where the operand the backend has may be
+    double lo = a->lo - ea, hi = a->hi + ea, far = fmax(-lo, hi);
+    switch (op) {
+        case OP_NEG:
+        case OP_ABS: return ea;
+        case OP_ADD:
+        case OP_SUB: return ea + eb + (fl ? round : 0);
+        case OP_MUL: return mag(a) * eb + mag(b) * ea + ea * eb + round;
+        case OP_DIV: {
+            double near = fmin(fabs(b->lo), fabs(b->hi)) - eb;
+            return near > 0 ? (ea + m * eb) / near + round : INFINITY;
+        }
+        case OP_MOD:
+            // fmodf is exact, away from the steps
+            if (!fl || eb > 0 || trunc(lo / b->lo) != trunc(hi / b->lo)) return INFINITY;
+            return ea;
+        case OP_POW: return pow_err(k, a, b, r);
+        case OP_ATAN2: {
+            // right of the cut the slope is 1 / |(x, y)| either way
+            double near = b->lo - eb;
+            return fl && near > 0 ? (ea + eb) / near + fn : INFINITY;
+        }
+        case OP_CEIL:
+        case OP_FLOOR: return unary[op - OP_ABS](lo) == unary[op - OP_ABS](hi) ? 0 : INFINITY;
+        case OP_SQRT:
+            // below 0 would be NaN; near 0 the slope has no bound, but the change is sqrt(ea) at most
+            if (lo < 0) return INFINITY;
+            return (lo > 0 ? fmin(ea / (2 * sqrt(lo)), sqrt(ea)) : sqrt(ea)) + round;
+        case OP_SIN:
+        case OP_COS:
+            if (fl) return far < FLOAT_TRIG_MAX ? ea + fn : INFINITY;
+            if (far + 2 >= FIXED_MAX) return INFINITY;
+            // the table, and 2 pi and pi / 2 not quite being what they are, once a turn
+            return ea + FIXED_SIN_ERR + ((far + 2) / (2 * PI) + 1) * fabs(FIXED_2PI * FIXED_ULP - 2 * PI) +
+                   fabs(FIXED_HALF_PI * FIXED_ULP - PI / 2);
+        case OP_TAN: {
+            if (!fl || far >= FLOAT_TRIG_MAX || holds(lo, hi, PI / 2, PI)) return INFINITY;
+            double t = fmax(fabs(tan(lo)), fabs(tan(hi)));
+            return (1 + t * t) * ea + fn;
+        }
+        case OP_EXP: return exp(hi) * ea + fn;
+        case OP_LN: return lo > 0 ? ea / lo + fn : INFINITY;
+        case OP_LOG10: return lo > 0 ? ea / lo / log(10) + fn : INFINITY;
+        case OP_ACOS:
+        case OP_ASIN: return far < 1 ? ea / sqrt(1 - far * far) + fn : INFINITY;
+        case OP_COSH:
+        case OP_SINH: return cosh(far) * ea + fn;
+        default: return ea + fn;        // atan, tanh: slopes of 1 at most
+    }
+}
+
+// how far backend k can be off for op giving r, out of range included
+static double backend_err(int k, int op, const graph_bound_t *a, const graph_bound_t *b, const graph_bound_t *r) {
+    if (!a->cont || !b->cont) return INFINITY;
+    double e = op_err(k, op, a, b, r);
+    return isnan(e) || mag(r) + e >= (k == GRAPH_FLOAT ? FLT_MAX : FIXED_MAX) ? INFINITY : e;
+}
+
+graph_bound_t graph_expr_bound(const graph_expr_t *p, double x0, double x1) {
+    // static: it would be a good part of the core 0 stack
+    static graph_bound_t st[GRAPH_EXPR_STACK];
+    const double *num = p->num;
+    int sp = 0;
+    for (int i = 0; i < p->n; i++) {
+        int op = p->op[i];
+        if (op == OP_NUM) {
+            graph_bound_t *r = &st[sp];
+            *r = span(*num, *num);
+            r->err[GRAPH_FLOAT] = fabs(*num - p->numf[num - p->num]);
+            r->err[GRAPH_FIXED] = fabs(*num) < FIXED_MAX ? fabs(*num - p->numq[num - p->num] * FIXED_ULP) : INFINITY;
+            sp++;
+            num++;
+            continue;
+        }
+        if (op == OP_X) {
+            graph_bound_t *r = &st[sp++];
+            *r = span(x0, x1);
+            r->err[GRAPH_FLOAT] = FLOAT_ROUND * mag(r);
+            r->err[GRAPH_FIXED] = mag(r) < FIXED_MAX ? FIXED_ULP / 2 : INFINITY;
+            continue;
+        }
+        graph_bound_t a = st[sp - 1], b = a, *r;
+        if (op < OP_ADD) {
+            r = &st[sp - 1];
+            if (a.cont) *r = span(-a.hi, -a.lo);
+        } else if (op >= OP_ABS) {
+            r = &st[sp - 1];
+            if (a.cont) *r = bound_unary(op, a);
+        } else {
+            a = st[--sp - 1];
+            r = &st[sp - 1];
+            // NaN stays NaN, but for pow(NaN, 0) and pow(1, NaN)
+            if (op == OP_POW && ((b.cont && b.lo == 0 && b.hi == 0) || (a.cont && a.lo == 1 && a.hi == 1)))
+                *r = span(1, 1);
+            else if (!a.cont || !b.cont) *r = a.none || b.none ? nowhere : unknown;
+            else switch (op) {
+                case OP_ADD: *r = span(a.lo + b.lo, a.hi + b.hi); break;
+                case OP_SUB: *r = span(a.lo - b.hi, a.hi - b.lo); break;
+                case OP_MUL: *r = corners(mul, a, b); break;
+                case OP_DIV: *r = b.lo <= 0 && b.hi >= 0 ? unknown : corners(dv, a, b); break;
+                case OP_MOD: *r = bound_mod(a, b); break;
+                case OP_POW: *r = bound_pow(a, b); break;
+                default: *r = bound_atan2(a, b); break;
+            }
+        }
+        if (r->cont) {
+            r->err[GRAPH_FLOAT] = backend_err(GRAPH_FLOAT, op, &a, &b, r);
+            r->err[GRAPH_FIXED] = backend_err(GRAPH_FIXED, op, &a, &b, r);
+        }
+    }
+    return st[0];
+}
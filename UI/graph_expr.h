@@ -0,0 +1,58 @@
+#ifndef COYOTE_GRAPH_EXPR_H
+#define COYOTE_GRAPH_EXPR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Expressions of x for the graph tab, compiled to a short postfix program that can
+// be evaluated at a point or bounded over a range of x. The grammar, functions and
+// arithmetic are tinyexpr's, so a point comes out exactly as te_eval() would give it.
+// What tinyexpr takes but this does not (fac, ncr, npr, a comma list, capitals)
+// fails to compile here and is left to tinyexpr.
+//
+// The same program also runs in float and in Q16.16 fixed point, which on the RP2040
+// (no FPU: double is all software, float goes to the ROM routines) are each a good
+// deal quicker. A bound says how far each can be off from double over its range, so
+// the graph can take the quickest that stays within what a pixel shows. Fixed point
+// has + - * /, abs, floor, ceil, sqrt, sin, cos and whole powers up to
+// GRAPH_EXPR_FIXED_POW; the rest is float or double only.
+
+#define GRAPH_EXPR_OPS      64
+#define GRAPH_EXPR_NUMS     32
+#define GRAPH_EXPR_STACK    16
+#define GRAPH_EXPR_FIXED_POW 8
+
+// quickest last
+enum {
+    GRAPH_DOUBLE,
+    GRAPH_FLOAT,
+    GRAPH_FIXED,
+    GRAPH_BACKENDS,
+};
+
+typedef struct {
+    uint8_t op[GRAPH_EXPR_OPS];
+    double num[GRAPH_EXPR_NUMS];        // the constants, in the order the program takes them
+    float numf[GRAPH_EXPR_NUMS];
+    int32_t numq[GRAPH_EXPR_NUMS];
+    int n;
+} graph_expr_t;
+
+// lo..hi holds every value from x0 to x1 when cont is set: the expression is defined
+// and continuous all the way. Without it nothing is known about the range, unless
+// none is set: then it is NaN all the way. With cont, err[b] is the most backend b
+// can be off by anywhere in the range, INFINITY where it is not to be used at all.
+typedef struct {
+    double lo, hi;
+    bool cont, none;
+    double err[GRAPH_BACKENDS];
+} graph_bound_t;
+
+extern bool graph_expr_compile(graph_expr_t *p, const char *s);
+extern double graph_expr_eval(const graph_expr_t *p, double x);
+// the same in float and in fixed point; NaN where fixed point has no value
+extern double graph_expr_evalf(const graph_expr_t *p, double x);
+extern double graph_expr_evalq(const graph_expr_t *p, double x);
+extern graph_bound_t graph_expr_bound(const graph_expr_t *p, double x0, double x1);
+
+#endif
@@ -1,11 +1,17 @@
 #include "ui.h"
 #include "lcdspi.h"
+#include "lcd_scroll.h"
+#include "lcd_cells.h"
+#include "lcd_framecache.h"
+#include "lcd_band.h"
+#include "lcd_console.h"
+#include "widget.h"
+#include "graph.h"
 #include "pico/stdlib.h"
 #include "pico/bootrom.h"
 #include <string.h>
 #include <stdio.h>
 #include <math.h>
-#include "tinyexpr/tinyexpr.h"
 #include "pwm_sound/pwm_sound.h"
 #include "keyboard_definition.h"
 #include "text_mode.h"
@@ -15,8 +21,11 @@
 #define MENU_H 6
 #define MAX_MENU_ITEMS 16
 #define MAX_GRAPH_FN 4
+#define GRAPH_PAN 8
 #define MENU_X ((LCD_WIDTH - MENU_W * 8) / 2)
 #define MENU_Y ((LCD_HEIGHT - MENU_H * 12) / 2)
+#define TAB_BAR_Y 295
+#define TAB_AREA 0, 0, LCD_WIDTH - 1, TAB_BAR_Y - 1
 
 typedef struct { char expression[INPUT_BUFFER_SIZE]; int color; bool active; } GraphFn;
 typedef struct { char label[32]; } MenuItem;
@@ -27,91 +36,99 @@ static const int graph_colors[] = {RED, BLUE, GREEN, MAGENTA};
 int tab_count = MAX_TABS;
 int active_tab = 0;
 TabContext tab_contexts[MAX_TABS];
+static lcd_cells_t tab_cells[MAX_TABS];
+// bumped whenever what a tab shows changes, so its cached picture is known to be stale
+static uint32_t tab_gen[MAX_TABS];
+static uint32_t redraw_us[MAX_TABS];   // time the last full redraw of a tab took on this core
 static app_mode_t current_mode = MODE_CALCULATOR;
 
-static void draw_menu_frame(int x, int y, int w, int h, const char* title) {
-    draw_rect_spi(x, y, x + w * 8, y + h * 12, BLACK);
-    lcd_set_text_color(WHITE, BLACK);
-    for (int i = 0; i < w; i++) {
-        char c = (i == 0 || i == w-1) ? '+' : '-';
-        lcd_print_char_at(WHITE, BLACK, c, 0, x + i*8, y);
-        lcd_print_char_at(WHITE, BLACK, c, 0, x + i*8, y + (h-1)*12);
-    }
-    for (int i = 1; i < h-1; i++) {
-        lcd_print_char_at(WHITE, BLACK, '|', 0, x, y + i*12);
-        lcd_print_char_at(WHITE, BLACK, '|', 0, x + (w-1)*8, y + i*12);
-    }
-    int tlen = strlen(title);
-    int tx = x + (w*8 - tlen*8) / 2;
-    for (int i = 0; i < tlen; i++)
-        lcd_print_char_at(WHITE, BLACK, title[i], 0, tx + i*8, y);
+static void show_tab_content();
+
+static void redraw_screen() {
+    if (current_mode == MODE_CALCULATOR) ui_redraw_tab_content(); else text_mode_redraw();
 }
 
-static void draw_menu_opt(int x, int y, int w, int row, const char* text, bool sel) {
-    int len = strlen(text);
-    int ox = x + (w*8 - len*8) / 2;
-    int fg = sel ? BLACK : WHITE, bg = sel ? WHITE : BLACK;
-    for (int i = 0; i < len; i++)
-        lcd_print_char_at(fg, bg, text[i], 0, ox + i*8, y + row*12);
+// Popups keep what they cover and put it back when they close. Not over the calculator
+// consoles: those are cell grids, and repainting the covered cells that are not blank
+// moves fewer bytes than a blit of the whole area.
+static void open_popup(widget_frame_t* frame) {
+    if (current_mode == MODE_TEXT || active_tab == 3) widget_frame_save(frame);
+    widget_frame_paint(frame);
 }
 
-static void draw_input_field(int x, int y, int w, int row, const char* text, int maxd) {
-    int fy = y + row*12, fx = x + 8;
-    draw_rect_spi(fx, fy, fx + (w-2)*8, fy + 12, BLACK);
-    int len = strlen(text);
-    int dlen = len > maxd ? maxd : len;
-    int dstart = len > maxd ? len - maxd : 0;
-    for (int i = 0; i < dlen; i++)
-        lcd_print_char_at(BLACK, WHITE, text[dstart + i], 0, fx + i*8, fy);
-    lcd_print_char_at(BLACK, WHITE, '_', 0, fx + dlen*8, fy);
+// takes a popup down: what it covered comes back, or is redrawn if it was not kept
+static void close_popup(widget_frame_t* frame) {
+    if (!widget_frame_close(frame)) redraw_screen();
 }
 
 static bool run_input_dialog(const char* title, char* out, int max_len) {
-    int x = MENU_X, y = (LCD_HEIGHT - 5*12)/2, maxd = MENU_W - 3;
-    char input[64] = {0};
-    int len = 0;
-    draw_menu_frame(x, y, MENU_W, 5, title);
-    draw_input_field(x, y, MENU_W, 2, input, maxd);
+    int x = MENU_X, y = (LCD_HEIGHT - 5*12)/2;
+    widget_frame_t frame;
+    widget_field_t field;
+    widget_frame_init(&frame, x, y, MENU_W, 5, title);
+    widget_field_init(&field, x + 8, y + 2*12, MENU_W - 2, max_len - 1);
+    open_popup(&frame);
+    widget_field_paint(&field);
     while (1) {
         int c = lcd_getc(0);
-        if (c == KEY_ENTER && len > 0) {
-            strncpy(out, input, max_len-1); out[max_len-1] = '\0';
+        if (c == KEY_ENTER && field.len > 0) {
+            strncpy(out, field.text, max_len-1); out[max_len-1] = '\0';
+            close_popup(&frame);
             return true;
-        } else if (c == KEY_ESC || (c == KEY_BACKSPACE && len == 0)) {
+        } else if (c == KEY_ESC || (c == KEY_BACKSPACE && field.len == 0)) {
+            close_popup(&frame);
             return false;
-        } else if (c == KEY_BACKSPACE && len > 0) {
-            input[--len] = '\0';
-            draw_input_field(x, y, MENU_W, 2, input, maxd);
-        } else if (c >= 32 && c < 127 && len < max_len-1 && len < 63) {
-            if (c != '/' && c != '\\' && c != ':' && c != '*' && c != '?' && c != '"' && c != '<' && c != '>' && c != '|') {
-                input[len++] = c; input[len] = '\0';
-                draw_input_field(x, y, MENU_W, 2, input, maxd);
-            }
+        } else if (c == KEY_BACKSPACE) {
+            widget_field_backspace(&field);
+        } else if (c >= 32 && c < 127) {
+            if (c != '/' && c != '\\' && c != ':' && c != '*' && c != '?' && c != '"' && c != '<' && c != '>' && c != '|')
+                widget_field_insert(&field, c);
         }
+        // only the cells that changed: the new character and the cursor
+        widget_field_paint(&field);
         sleep_ms(20);
     }
 }
 
-static int run_menu(int x, int y, int w, int h, const char* title, MenuItem* items, int cnt, int sel) {
-    draw_menu_frame(x, y, w, h, title);
-    for (int i = 0; i < cnt; i++) draw_menu_opt(x, y, w, 2+i, items[i].label, i == sel);
+// runs an open menu until an item is picked (its index) or it is left (-1)
+static int menu_loop(widget_list_t* list) {
     while (1) {
         int c = lcd_getc(0);
-        if (c == KEY_UP && sel > 0) sel--;
-        else if (c == KEY_DOWN && sel < cnt-1) sel++;
-        else if (c == KEY_ENTER) return sel;
+        if (c == KEY_UP) widget_list_select(list, list->sel - 1);
+        else if (c == KEY_DOWN) widget_list_select(list, list->sel + 1);
+        else if (c == KEY_ENTER) return list->sel;
         else if (c == KEY_ESC || c == KEY_BACKSPACE) return -1;
-        else { sleep_ms(20); continue; }
-        for (int i = 0; i < cnt; i++) draw_menu_opt(x, y, w, 2+i, items[i].label, i == sel);
+        // only the rows whose selection changed
+        widget_list_paint(list);
         sleep_ms(20);
     }
 }
 
+static void open_menu(widget_frame_t* frame, widget_list_t* list, int x, int y, int w, int h, const char* title,
+                      const char* const* labels, int cnt, int sel) {
+    widget_frame_init(frame, x, y, w, h, title);
+    widget_list_init(list, x, y + 2*12, w, labels, cnt, sel);
+    open_popup(frame);
+    widget_list_paint(list);
+}
+
+// the menu is left up for the caller to close, or drop if it redraws the screen anyway
+static int run_menu(widget_frame_t* frame, int x, int y, int w, int h, const char* title, MenuItem* items,
+                    int cnt, int sel) {
+    const char* labels[MAX_MENU_ITEMS];
+    widget_list_t list;
+    for (int i = 0; i < cnt; i++) labels[i] = items[i].label;
+    open_menu(frame, &list, x, y, w, h, title, labels, cnt, sel);
+    return menu_loop(&list);
+}
+
+// the tab bar only, the tab content is redrawn on its own
 static void draw() {
-    lcd_clear();
-    draw_rect_spi(0, 295, 320, 320, WHITE);
+    // only the rows above the tab bar scroll
+    lcd_scroll_define(TAB_BAR_Y);
+    draw_rect_spi(0, TAB_BAR_Y, 320, 320, WHITE);
     for (int i = 0; i < tab_count; i++) {
-        int x = i*40 + 10, y = (i == active_tab) ? 295 : 300;
+        int x = i*40 + 10, y = (i == active_tab) ? TAB_BAR_Y : TAB_BAR_Y + 5;
         draw_rect_spi(x, y, x+20, 320, GRAY);
         lcd_print_char_at(WHITE, GRAY, '1'+i, 0, x+5, y+5);
     }
@@ -122,14 +139,18 @@ app_mode_t ui_get_current_mode() { return current_mode; }
 
 void ui_set_current_mode(app_mode_t mode) {
     current_mode = mode;
-    if (mode == MODE_CALCULATOR) { draw(); ui_redraw_tab_content(); }
+    if (mode == MODE_CALCULATOR) { draw(); show_tab_content(); }
     else text_mode_redraw();
 }
 
 void update_active_tab(int t) {
     if (t >= 0 && t < tab_count) {
-        if (active_tab != t) sound_play(SND_TAB_SWITCH);
-        active_tab = t; draw(); ui_redraw_tab_content();
+        if (active_tab != t) {
+            sound_play(SND_TAB_SWITCH);
+            // a picture of the tab being left, for when it comes back unchanged
+            lcd_frame_store(active_tab, tab_gen[active_tab], TAB_AREA);
+        }
+        active_tab = t; draw(); show_tab_content();
     }
 }
 
@@ -138,6 +159,12 @@ void ui_init() {
     lcd_init(); draw(); ui_redraw_tab_content();
 }
 
+// what tab i shows has changed: its cached picture is stale and gives up its slot
+void ui_touch_tab(int i) {
+    if (i < 0 || i >= MAX_TABS) return;
+    tab_gen[i]++;
+    lcd_frame_evict(i);
+}
 TabContext* ui_get_tab_context(int i) { return (i >= 0 && i < MAX_TABS) ? &tab_contexts[i] : NULL; }
 int ui_get_active_tab_idx() { return active_tab; }
 
@@ -152,47 +179,22 @@ void ui_add_to_history(int idx, const char* expr, double result) {
     ctx->history[ctx->history_count].result = result;
     ctx->history[ctx->history_count].has_result = true;
     ctx->history_count++;
+    ui_touch_tab(idx);
 }
 
-static void draw_graph_fn(const char* expr, int color) {
-    if (!expr || !expr[0]) return;
-    double x_val;
-    te_variable vars[] = {{"x", &x_val}};
-    te_expr *e = te_compile(expr, vars, 1, 0);
-    if (!e) return;
-    int last_sy = -1;
-    for (int sx = 0; sx < 320; sx++) {
-        x_val = (sx - 160) / 16.0;
-        double yv = te_eval(e);
-        if (isnan(yv) || isinf(yv)) { last_sy = -1; continue; }
-        int sy = 154 - (int)(yv * 16);
-        if (sy >= 14 && sy <= 294) {
-            if (last_sy != -1) {
-                int ys = last_sy < sy ? last_sy : sy, ye = last_sy < sy ? sy : last_sy;
-                for (int y = ys; y <= ye; y++) if (y >= 14 && y <= 294) spi_draw_pixel(sx, y, color);
-            } else spi_draw_pixel(sx, sy, color);
-            last_sy = sy;
-        } else last_sy = -1;
-    }
-    te_free(e);
-}
+#define GRAPH_LAST (GRAPH_CURVES - 1)
 
 void ui_draw_graph(const char* expr) {
     if (!expr || !expr[0]) return;
-    double x_val;
-    te_variable vars[] = {{"x", &x_val}};
-    te_expr *e = te_compile(expr, vars, 1, 0);
-    if (!e) {
+    if (!graph_set(GRAPH_LAST, expr)) {
         set_current_x(0); set_current_y(20);
         lcd_print_string("Graph Error");
         return;
     }
-    te_free(e);
-    draw_rect_spi(0, 154, 319, 154, GRAY);
-    draw_rect_spi(160, 14, 160, 294, GRAY);
+    graph_draw_axes();
     for (int i = 0; i < MAX_GRAPH_FN; i++)
-        if (graph_fns[i].active) draw_graph_fn(graph_fns[i].expression, graph_fns[i].color);
-    draw_graph_fn(expr, RED);
+        if (graph_fns[i].active && graph_set(i, graph_fns[i].expression)) graph_draw(i, graph_fns[i].color);
+    graph_draw(GRAPH_LAST, RED);
 }
 
 bool ui_graph_add_function(const char* expr) {
@@ -201,6 +203,7 @@ bool ui_graph_add_function(const char* expr) {
             strncpy(graph_fns[i].expression, expr, INPUT_BUFFER_SIZE-1);
             graph_fns[i].color = graph_colors[i];
             graph_fns[i].active = true;
+            ui_touch_tab(3);
             return true;
         }
     }
@@ -208,7 +211,59 @@ bool ui_graph_add_function(const char* expr) {
 }
 
 void ui_graph_clear_all() {
-    for (int i = 0; i < MAX_GRAPH_FN; i++) { graph_fns[i].active = false; graph_fns[i].expression[0] = '\0'; }
+    for (int i = 0; i < MAX_GRAPH_FN; i++) {
+        graph_fns[i].active = false;
+        graph_fns[i].expression[0] = '\0';
+        graph_forget(i);
+    }
+    ui_touch_tab(3);
+}
+
+// arrows move the view, Shift+Up (PAGE_UP) zooms in and Shift+Down (PAGE_DOWN) out;
+// false for any other key, which is then typed, + and - included
+bool ui_graph_view_key(int key) {
+    switch (key) {
+        case KEY_LEFT: graph_pan(-GRAPH_PAN, 0); break;
+        case KEY_RIGHT: graph_pan(GRAPH_PAN, 0); break;
+        case KEY_UP: graph_pan(0, GRAPH_PAN); break;
+        case KEY_DOWN: graph_pan(0, -GRAPH_PAN); break;
+        case KEY_PAGE_UP:
+        case KEY_PAGE_DOWN:
+            if (!graph_zoom(key == KEY_PAGE_UP)) { sound_play(SND_ERROR); return true; }
+            break;
+        default: return false;
+    }
+    ui_touch_tab(3);
+    ui_redraw_tab_content();
+    return true;
+}
+
+// history and prompt of a calculator tab, as a cell grid
+static void build_console(int idx) {
+    TabContext* ctx = &tab_contexts[idx];
+    lcd_cells_t* g = &tab_cells[idx];
+    char buf[64];
+    lcd_cells_clear(g, BLACK, WHITE);
+    for (int i = 0; i < ctx->history_count; i++) {
+        lcd_cells_print(g, ctx->history[i].expression);
+        sprintf(buf, "\n = %f\n", ctx->history[i].result);
+        lcd_cells_print(g, buf);
+    }
+    lcd_cells_print(g, "> "); lcd_cells_print(g, ctx->current_input);
+}
+
+// only the cells that differ from what is on the panel get drawn; a whole console
+// goes through the band compositor, so the clear under the text is not sent as well
+static void present_console(int idx) {
+    bool full = !lcd_cells_valid();
+    if (full) {
+        lcd_band_begin();
+        draw_rect_spi(0, 0, 320, TAB_BAR_Y - 1, WHITE);
+        lcd_cells_blank(WHITE);
+    }
+    build_console(idx);
+    lcd_cells_present(&tab_cells[idx]);
+    if (full) lcd_band_end();
 }
 
 void ui_redraw_input_only() {
@@ -217,55 +272,72 @@ void ui_redraw_input_only() {
         draw_rect_spi(0, 280, 320, 294, WHITE);
         set_current_x(0); set_current_y(281);
         lcd_set_text_color(BLACK, WHITE);
-        lcd_print_string("f(x)="); lcd_print_string(ctx->current_input);
-    } else {
-        int y = ctx->history_count * 24;
-        draw_rect_spi(0, y, 320, y+8, WHITE);
-        set_current_x(0); set_current_y(y);
-        lcd_set_text_color(BLACK, WHITE);
-        lcd_print_string("> "); lcd_print_string(ctx->current_input);
-    }
+        lcd_console_printf("f(x)=%s", ctx->current_input);
+    } else present_console(active_tab);
 }
 
 void ui_redraw_tab_content() {
     TabContext* ctx = &tab_contexts[active_tab];
     if (active_tab == 3) {
+        lcd_cells_invalidate();
         draw_rect_spi(0, 0, 320, 294, BLACK);
         if (ctx->history_count > 0) ui_draw_graph(ctx->history[ctx->history_count-1].expression);
         ui_redraw_input_only();
-    } else {
-        draw_rect_spi(0, 0, 320, 294, WHITE);
-        set_current_x(0); set_current_y(0);
-        lcd_set_text_color(BLACK, WHITE);
-        for (int i = 0; i < ctx->history_count; i++) {
-            char buf[64];
-            lcd_print_string(ctx->history[i].expression);
-            sprintf(buf, "\n = %f\n", ctx->history[i].result);
-            lcd_print_string(buf);
-        }
-        lcd_print_string("> "); lcd_print_string(ctx->current_input);
+    } else present_console(active_tab);
+}
+
+// The active tab's content, streamed from its cached picture if it has not changed
+// since and that is cheaper than drawing it again. A full redraw costs the clear of
+// the area (packed, half a byte a pixel) plus the time it took last time, counted as
+// the bytes the bus could have sent meanwhile. A console tab over another is brought
+// up cell by cell, which beats both.
+static void show_tab_content() {
+    bool console = active_tab != 3;
+    if (console && lcd_cells_valid()) { ui_redraw_tab_content(); return; }
+    uint32_t cost = lcd_frame_cost(active_tab, tab_gen[active_tab], TAB_AREA);
+    uint64_t redraw = LCD_WIDTH * TAB_BAR_Y / 2 + (uint64_t) redraw_us[active_tab] * (LCD_SPI_SPEED / 8) / 1000000;
+    if (cost && cost < redraw && lcd_frame_show(active_tab, tab_gen[active_tab], TAB_AREA)) {
+        if (console) { build_console(active_tab); lcd_cells_assume(&tab_cells[active_tab]); }
+        else lcd_cells_invalidate();
+        return;
     }
+    uint64_t t0 = time_us_64();
+    ui_redraw_tab_content();
+    redraw_us[active_tab] = time_us_64() - t0;
 }
 
 void ui_show_mode_menu() {
     MenuItem items[] = {{" Text "}, {" Calculator "}};
-    int sel = run_menu(MENU_X, MENU_Y, MENU_W, MENU_H, " MODE ", items, 2, current_mode == MODE_TEXT ? 0 : 1);
-    if (sel == 0) ui_set_current_mode(MODE_TEXT);
-    else if (sel == 1) ui_set_current_mode(MODE_CALCULATOR);
-    else { if (current_mode == MODE_CALCULATOR) ui_redraw_tab_content(); else text_mode_redraw(); }
+    widget_frame_t frame;
+    // the tab as it is, before the menu covers it, for coming back from text mode
+    if (current_mode == MODE_CALCULATOR) lcd_frame_store(active_tab, tab_gen[active_tab], TAB_AREA);
+    int sel = run_menu(&frame, MENU_X, MENU_Y, MENU_W, MENU_H, " MODE ", items, 2, current_mode == MODE_TEXT ? 0 : 1);
+    app_mode_t mode = sel == 0 ? MODE_TEXT : MODE_CALCULATOR;
+    if (sel >= 0 && mode != current_mode) { widget_frame_drop(&frame); ui_set_current_mode(mode); }
+    else close_popup(&frame);
 }
 
 void ui_show_menu() {
     MenuItem items[2];
+    const char* labels[] = {items[0].label, items[1].label};
+    widget_frame_t frame;
+    widget_list_t list;
+    snprintf(items[0].label, 32, " %s Beeps ", sound_is_enabled() ? "Disable" : "Enable ");
+    strcpy(items[1].label, " Reboot ");
+    open_menu(&frame, &list, MENU_X, MENU_Y, MENU_W, MENU_H, " SETTINGS ", labels, 2, 0);
     while (1) {
-        snprintf(items[0].label, 32, " %s Beeps ", sound_is_enabled() ? "Disable" : "Enable ");
-        strcpy(items[1].label, " Reboot ");
-        int sel = run_menu(MENU_X, MENU_Y, MENU_W, MENU_H, " SETTINGS ", items, 2, 0);
-        if (sel == 0) sound_set_enabled(!sound_is_enabled());
-        else if (sel == 1) { lcd_clear(); lcd_print_string("Rebooting...\n"); sleep_ms(500); reset_usb_boot(1,0); }
+        int sel = menu_loop(&list);
+        if (sel == 0) {
+            // the menu stays up, only the toggled item changes
+            sound_set_enabled(!sound_is_enabled());
+            snprintf(items[0].label, 32, " %s Beeps ", sound_is_enabled() ? "Disable" : "Enable ");
+            widget_list_invalidate_row(&list, 0);
+            widget_list_paint(&list);
+        }
+        else if (sel == 1) { lcd_clear(); lcd_set_text_color(WHITE, BLACK); lcd_print_string("Rebooting...\n"); lcd_flush(); sleep_ms(500); reset_usb_boot(1,0); }
         else break;
     }
-    ui_redraw_tab_content();
+    close_popup(&frame);
 }
 
 bool ui_show_file_menu(const char* dir, char* out, int max_len) {
@@ -286,18 +358,31 @@ bool ui_show_file_menu(const char* dir, char* out, int max_len) {
     }
     if (!cnt) { strcpy(items[0].label, " (empty) "); cnt = 1; }
     int h = cnt + 3; if (h > 20) h = 20;
-    int sel = run_menu(MENU_X, (LCD_HEIGHT - h*12)/2, MENU_W, h, " FILES ", items, cnt, 0);
-    if (sel >= 0 && has && out) { strncpy(out, fnames[sel], max_len-1); out[max_len-1] = '\0'; return true; }
+    widget_frame_t frame;
+    int sel = run_menu(&frame, MENU_X, (LCD_HEIGHT - h*12)/2, MENU_W, h, " FILES ", items, cnt, 0);
+    if (sel >= 0 && has && out) {
+        // the caller redraws for the file it opens
+        widget_frame_drop(&frame);
+        strncpy(out, fnames[sel], max_len-1); out[max_len-1] = '\0';
+        return true;
+    }
+    close_popup(&frame);
     return false;
 }
 
 bool ui_show_save_prompt(char* out, int max_len) { return run_input_dialog(" SAVE AS ", out, max_len); }
 
 void ui_show_graph_menu() {
-    MenuItem items[] = {{" Add Function "}, {" Clear All "}, {" Cancel "}};
-    int sel = run_menu(MENU_X, MENU_Y, MENU_W, MENU_H, " GRAPH ", items, 3, 0);
+    MenuItem items[] = {{" Add Function "}, {" Clear All "}, {""}, {" Cancel "}};
+    widget_frame_t frame;
+    snprintf(items[2].label, 32, " %s ", graph_adaptive() ? "Every Column" : "Adaptive");
+    int h = 4 + 3;
+    int sel = run_menu(&frame, MENU_X, (LCD_HEIGHT - h*12)/2, MENU_W, h, " GRAPH ", items, 4, 0);
     TabContext* ctx = ui_get_tab_context(3);
     if (sel == 0 && ctx->history_count > 0) ui_graph_add_function(ctx->history[ctx->history_count-1].expression);
     else if (sel == 1) ui_graph_clear_all();
+    else if (sel == 2) { graph_set_adaptive(!graph_adaptive()); ui_touch_tab(3); }
+    else { close_popup(&frame); return; }
+    widget_frame_drop(&frame);
     ui_redraw_tab_content();
 }
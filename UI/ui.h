@@ -25,6 +25,8 @@ typedef enum { MODE_CALCULATOR, MODE_TEXT } app_mode_t;
 void ui_init();
 void update_active_tab(int new_tab);
 TabContext* ui_get_tab_context(int tab_idx);
+// after changing a tab's context directly, so a cached picture of it is not used
+void ui_touch_tab(int tab_idx);
 int ui_get_active_tab_idx();
 void ui_add_to_history(int tab_idx, const char* expression, double result);
 void ui_redraw_tab_content();
@@ -38,5 +40,6 @@ app_mode_t ui_get_current_mode();
 void ui_set_current_mode(app_mode_t mode);
 bool ui_graph_add_function(const char* expression);
 void ui_graph_clear_all();
+bool ui_graph_view_key(int key);
 
 #endif
@@ -0,0 +1,156 @@
+#include <string.h>
+
+#include "widget.h"
+#include "lcdspi.h"
+#include "lcd_cells.h"
+
+void widget_frame_init(widget_frame_t *f, int x, int y, int cols, int rows, const char *title) {
+    f->x = x;
+    f->y = y;
+    f->cols = cols;
+    f->rows = rows;
+    f->title = title;
+    f->invalid = true;
+    f->under = NULL;
+}
+
+void widget_frame_paint(widget_frame_t *f) {
+    if (!f->invalid) return;
+    int x2 = f->x + f->cols * 8, y2 = f->y + f->rows * 12;
+    // cells under a kept area come back as they were
+    if (!f->under) lcd_cells_invalidate_area(f->x, f->y, x2, y2);
+    draw_rect_spi(f->x, f->y, x2, y2, BLACK);
+    // the border runs through the middle of the outer cells, where the strokes of the
+    // '+', '-' and '|' glyphs it used to be drawn with were: four lines rather than
+    // a glyph window for every outer cell
+    int lx = f->x + 3, rx = f->x + (f->cols - 1) * 8 + 3;
+    int ty = f->y + 5, by = f->y + (f->rows - 1) * 12 + 5;
+    draw_hline(lx, rx, ty, WHITE);
+    draw_hline(lx, rx, by, WHITE);
+    draw_vline(lx, ty, by, WHITE);
+    draw_vline(rx, ty, by, WHITE);
+    int tlen = strlen(f->title);
+    lcd_print_run(WHITE, BLACK, f->title, tlen, f->x + (f->cols * 8 - tlen * 8) / 2, f->y);
+    f->invalid = false;
+}
+
+void widget_frame_save(widget_frame_t *f) {
+    f->under = lcd_save_under(f->x, f->y, f->x + f->cols * 8, f->y + f->rows * 12);
+}
+
+bool widget_frame_close(widget_frame_t *f) {
+    if (!f->under) return false;
+    lcd_save_restore(f->under);
+    f->under = NULL;
+    return true;
+}
+
+void widget_frame_drop(widget_frame_t *f) {
+    if (f->under) lcd_save_drop(f->under);
+    f->under = NULL;
+}
+
+void widget_label_init(widget_label_t *l, int x, int y, int cols, uint32_t fc, uint32_t bc, uint32_t blank) {
+    l->x = x;
+    l->y = y;
+    l->cols = cols < WIDGET_COLS ? cols : WIDGET_COLS;
+    l->fc = fc;
+    l->bc = bc;
+    l->blank = blank;
+    l->len = 0;
+    l->shown_len = -1;
+}
+
+void widget_label_set(widget_label_t *l, const char *text, int len) {
+    if (len > l->cols) len = l->cols;
+    memcpy(l->text, text, len);
+    l->len = len;
+}
+
+// draws the cells between the first and the last that differ from what is shown,
+// and blanks those the text no longer reaches
+void widget_label_paint(widget_label_t *l) {
+    int from = 0, to = l->len, old = l->shown_len < 0 ? l->cols : l->shown_len;
+    if (l->shown_len >= 0) {
+        while (from < to && from < l->shown_len && l->shown[from] == l->text[from]) from++;
+        if (l->shown_len == l->len)
+            while (to > from && l->shown[to - 1] == l->text[to - 1]) to--;
+    }
+    if (to > from) lcd_print_run(l->fc, l->bc, l->text + from, to - from, l->x + from * 8, l->y);
+    if (old > l->len) draw_rect_spi(l->x + l->len * 8, l->y, l->x + old * 8 - 1, l->y + 11, l->blank);
+    memcpy(l->shown, l->text, l->len);
+    l->shown_len = l->len;
+}
+
+void widget_list_init(widget_list_t *l, int x, int y, int cols, const char *const *items, int count, int sel) {
+    l->x = x;
+    l->y = y;
+    l->cols = cols;
+    l->items = items;
+    l->count = count < WIDGET_LIST_MAX ? count : WIDGET_LIST_MAX;
+    l->sel = sel;
+    widget_list_invalidate(l);
+}
+
+void widget_list_select(widget_list_t *l, int sel) {
+    if (sel < 0 || sel >= l->count || sel == l->sel) return;
+    widget_list_invalidate_row(l, l->sel);
+    widget_list_invalidate_row(l, sel);
+    l->sel = sel;
+}
+
+// the item has to keep its length, the row is not cleared first
+void widget_list_invalidate_row(widget_list_t *l, int row) {
+    if (row >= 0 && row < l->count) l->dirty |= 1u << row;
+}
+
+void widget_list_invalidate(widget_list_t *l) {
+    l->dirty = l->count == 32 ? ~0u : (1u << l->count) - 1;
+}
+
+void widget_list_paint(widget_list_t *l) {
+    for (int i = 0; l->dirty; i++) {
+        if (!(l->dirty & (1u << i))) continue;
+        l->dirty &= ~(1u << i);
+        int len = strlen(l->items[i]);
+        bool sel = i == l->sel;
+        lcd_print_run(sel ? BLACK : WHITE, sel ? WHITE : BLACK, l->items[i], len,
+                      l->x + (l->cols * 8 - len * 8) / 2, l->y + i * 12);
+    }
+}
+
+// the end of the text that fits, then the cursor
+static void field_show(widget_field_t *f) {
+    char line[WIDGET_COLS];
+    int room = f->view.cols - 1, start = f->len > room ? f->len - room : 0, n = f->len - start;
+    memcpy(line, f->text + start, n);
+    line[n] = '_';
+    widget_label_set(&f->view, line, n + 1);
+}
+
+void widget_field_init(widget_field_t *f, int x, int y, int cols, int max) {
+    widget_label_init(&f->view, x, y, cols, BLACK, WHITE, BLACK);
+    f->len = 0;
+    f->text[0] = '\0';
+    f->max = max < (int) sizeof(f->text) - 1 ? max : (int) sizeof(f->text) - 1;
+    field_show(f);
+}
+
+bool widget_field_insert(widget_field_t *f, char c) {
+    if (f->len >= f->max) return false;
+    f->text[f->len++] = c;
+    f->text[f->len] = '\0';
+    field_show(f);
+    return true;
+}
+
+bool widget_field_backspace(widget_field_t *f) {
+    if (!f->len) return false;
+    f->text[--f->len] = '\0';
+    field_show(f);
+    return true;
+}
+
+void widget_field_paint(widget_field_t *f) {
+    widget_label_paint(&f->view);
+}
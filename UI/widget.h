@@ -0,0 +1,78 @@
+#ifndef COYOTE_WIDGET_H
+#define COYOTE_WIDGET_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "lcdspi.h"
+#include "lcd_saveunder.h"
+
+// Retained widgets for menus and dialogs, laid out in cells of the 8x12 main font.
+// Each widget remembers what it has put on the panel; changing it only marks what
+// differs, and widget_*_paint() draws just that. widget_list_invalidate() makes
+// the next paint draw the list in full, e.g. after something else drew over it.
+
+#define WIDGET_COLS         (LCD_WIDTH / 8)
+#define WIDGET_LIST_MAX     32
+
+// box with a title in the top border; the inside is cleared to black
+typedef struct {
+    int x, y, cols, rows;
+    const char *title;
+    bool invalid;
+    lcd_save_t *under;      // what the frame covers, see widget_frame_save()
+} widget_frame_t;
+
+// one line of text in fc on bc; the cells past its end are blank
+typedef struct {
+    int x, y, cols;
+    uint32_t fc, bc, blank;
+    char text[WIDGET_COLS];
+    int len;
+    char shown[WIDGET_COLS];
+    int shown_len;          // -1: nothing known to be on the panel
+} widget_label_t;
+
+// items centred one a row, the selected one inverted
+typedef struct {
+    int x, y, cols;
+    const char *const *items;
+    int count, sel;
+    uint32_t dirty;         // a bit for each row to repaint
+} widget_list_t;
+
+// one line of input, its end and a cursor shown in a label
+typedef struct {
+    widget_label_t view;
+    char text[64];
+    int len, max;
+} widget_field_t;
+
+extern void widget_frame_init(widget_frame_t *f, int x, int y, int cols, int rows, const char *title);
+extern void widget_frame_paint(widget_frame_t *f);
+// before the first paint: keeps what the frame will cover, for widget_frame_close()
+extern void widget_frame_save(widget_frame_t *f);
+// puts back what the frame covered; false if it was not kept and has to be redrawn
+extern bool widget_frame_close(widget_frame_t *f);
+// forgets what the frame covered, for when the screen is redrawn anyway
+extern void widget_frame_drop(widget_frame_t *f);
+
+extern void widget_label_init(widget_label_t *l, int x, int y, int cols, uint32_t fc, uint32_t bc, uint32_t blank);
+extern void widget_label_set(widget_label_t *l, const char *text, int len);
+extern void widget_label_paint(widget_label_t *l);
+
+extern void widget_list_init(widget_list_t *l, int x, int y, int cols, const char *const *items, int count, int sel);
+// marks the old and the new row, nothing else
+extern void widget_list_select(widget_list_t *l, int sel);
+// after items[row] has changed
+extern void widget_list_invalidate_row(widget_list_t *l, int row);
+extern void widget_list_invalidate(widget_list_t *l);
+extern void widget_list_paint(widget_list_t *l);
+
+// max: longest text, at most sizeof(text) - 1
+extern void widget_field_init(widget_field_t *f, int x, int y, int cols, int max);
+extern bool widget_field_insert(widget_field_t *f, char c);
+extern bool widget_field_backspace(widget_field_t *f);
+extern void widget_field_paint(widget_field_t *f);
+
+#endif
@@ -12,5 +12,9 @@
 #define SD_CS_PIN       17
 #define SD_DET_PIN 22
 
+#ifndef COYOTE_DIR
+#define COYOTE_DIR "/coyote"
+#endif
+
 
 #endif //COYOTE_CONFIG_H
\ No newline at end of file
@@ -0,0 +1,871 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "pico/stdlib.h"
+
+#include "lcdspi.h"
+#include "lcd_render.h"
+#include "lcd_band.h"
+#include "lcd_sprite.h"
+#include "lcd_driver.h"
+#include "lcd_dma.h"
+#include "lcd_scroll.h"
+#include "lcd_screenshot.h"
+#include "lcd_bmp.h"
+#include "lcd_console.h"
+#include "UI/graph.h"
+#include "tinyexpr/tinyexpr.h"
+#include "panel.h"
+#include "sim.h"
+
+// Drawing benchmark, without a key script:
+//  - a few typical screens drawn straight to the panel and through the band
+//    compositor (lcd_band.h), with the bus traffic and host time of each and a check
+//    that both leave the same pixels on the panel
+//  - lines of text drawn a glyph at a time through draw_bitmap_spi(), as
+//    lcd_print_char() used to, and as one run: the bytes, commands, windows and host
+//    time a line, and a check that both leave the same pixels
+//  - windows in pure colours, which go out in 3 bit (COLMOD 0x61) two pixels a byte,
+//    against their 18 bit size, and one in another colour that has to stay 18 bit
+//  - text rows built the way the render core builds them, without the bus; built
+//    as coyote_bench_generic as well, without the templates of lcd_driver.h
+//  - scaled bitmaps at random sizes, scales and positions, drawn directly and banded,
+//    against a copy of the per-pixel float sampling draw_bitmap_spi() used to do
+//  - sprites bouncing over a tile map (lcd_sprite.h), with the traffic a frame takes
+//    for different numbers of them and the frame rate the bus allows for that; the
+//    last frame is checked against a full redraw of the stage
+//  - the render queue (lcd_queue.h) between two threads, every command checked on
+//    the consumer side for order and contents
+//  - the transfer engine (lcd_dma.h) stepped a block at a time into a sink: the bytes
+//    of sends and repeated fills, and fences and callbacks completing in order
+//  - the console scrolled by hardware scrolling (lcd_scroll.h): the rows the panel
+//    shows after each step against lcd_scroll_mock_shown_row() and against where
+//    the rows should have gone, and a row drawn after scrolling
+//  - a scrolled screen written by the panel model (panel_write_bmp()), decoded and
+//    checked against its pixels, and against lcd_screenshot() of the same screen
+//  - curves plotted pixel by pixel, as the graph tab used to, and as the spans of
+//    graph_draw(): the bus bytes and windows of each
+//  - curves of the graph tab (UI/graph.h) sampled every column and adaptively, at
+//    two zooms: the evaluations and bounds each takes, its host time, and how many
+//    pixels the two leave differently
+
+#define RUNS 20
+
+typedef struct {
+    const char *name;
+    void (*draw)(void);
+} scene_t;
+
+static uint32_t shown[PANEL_H][PANEL_W];
+
+// the calculator console: cleared to white, then a screen of text
+static void scene_console(void) {
+    char line[41];
+    draw_rect_spi(0, 0, 320, 294, WHITE);
+    for (int r = 0; r < 24; r++) {
+        int n;
+        if (r & 1) n = snprintf(line, sizeof(line), " = %f", r * 7 + sin(r));
+        else n = snprintf(line, sizeof(line), "%d*%d+sin(%d)", r * 7, r + 3, r);
+        lcd_print_run(BLACK, WHITE, line, n, 0, r * 12);
+    }
+}
+
+// the graph tab: axes and two curves, flat stretches as hlines and steps as vlines
+static void curve(double (*f)(double), int colour) {
+    int last = -1;
+    for (int sx = 0; sx < 320; sx++) {
+        double y = f((sx - 160) / 16.0);
+        int sy = isnan(y) ? -1 : 154 - (int) (y * 16);
+        if (sy < 14 || sy > 294) {
+            last = -1;
+            continue;
+        }
+        if (last == -1 || last == sy) draw_hline(sx, sx, sy, colour);
+        else draw_vline(sx, last, sy, colour);
+        last = sy;
+    }
+}
+
+static double square(double x) {
+    return x * x / 4;
+}
+
+static void scene_graph(void) {
+    draw_rect_spi(0, 0, 320, 294, BLACK);
+    draw_hline(0, 319, 154, GRAY);
+    draw_vline(160, 14, 294, GRAY);
+    curve(sin, RED);
+    curve(square, BLUE);
+}
+
+// a popup menu over whatever is there
+static void scene_menu(void) {
+    int x = 72, y = 124;
+    draw_rect_spi(x, y, x + 176, y + 72, BLACK);
+    draw_hline(x + 3, x + 171, y + 5, WHITE);
+    draw_hline(x + 3, x + 171, y + 65, WHITE);
+    draw_vline(x + 3, y + 5, y + 65, WHITE);
+    draw_vline(x + 171, y + 5, y + 65, WHITE);
+    lcd_print_run(WHITE, BLACK, " SETTINGS ", 10, x + 48, y);
+    lcd_print_run(BLACK, WHITE, " Disable Beeps ", 15, x + 28, y + 24);
+    lcd_print_run(WHITE, BLACK, " Reboot ", 8, x + 56, y + 36);
+}
+
+// the tab bar and a big result, overdrawn pieces of different sizes
+static void scene_result(void) {
+    draw_rect_spi(0, 295, 320, 320, WHITE);
+    for (int i = 0; i < 4; i++) {
+        draw_rect_spi(i * 40 + 10, i ? 300 : 295, i * 40 + 30, 320, GRAY);
+        lcd_print_char_at(WHITE, GRAY, '1' + i, 0, i * 40 + 15, (i ? 300 : 295) + 5);
+    }
+    draw_rect_spi(0, 200, 320, 260, WHITE);
+    lcd_print_glyphs(&lcd_font_digits, BLACK, WHITE, "-12.3456e7", 10, 40, 210);
+    draw_line_spi(0, 199, 319, 261, MAGENTA);
+}
+
+static const scene_t scenes[] = {
+    {"console", scene_console},
+    {"graph", scene_graph},
+    {"menu", scene_menu},
+    {"result", scene_result},
+};
+
+// stripes of colours the 3 bit format does not have, so uncovered pixels show
+static void background(void) {
+    for (int i = 0; i < 20; i++) draw_rect_spi(0, i * 16, 319, i * 16 + 15, RGB(i * 12, 200 - i * 8, 90));
+    lcd_render_sync();
+}
+
+static void grab(void) {
+    for (int y = 0; y < PANEL_H; y++)
+        for (int x = 0; x < PANEL_W; x++) shown[y][x] = panel_pixel(x, y);
+}
+
+// at the 6 bits a channel the panel has: 3 bit full on and 18 bit 0xFF are the same
+static int differ(void) {
+    int n = 0;
+    for (int y = 0; y < PANEL_H; y++)
+        for (int x = 0; x < PANEL_W; x++) n += ((shown[y][x] ^ panel_pixel(x, y)) & 0xFCFCFC) != 0;
+    return n;
+}
+
+static void measure(const scene_t *s, bool banded) {
+    uint32_t bytes = 0, windows = 0;
+    uint64_t us = 0;
+    for (int i = 0; i < RUNS; i++) {
+        background();
+        lcd_stats_t before = lcd_stats;
+        uint64_t t = time_us_64();
+        if (banded) lcd_band_begin();
+        s->draw();
+        if (banded) lcd_band_end();
+        lcd_render_sync();
+        us += time_us_64() - t;
+        bytes = lcd_stats.bytes - before.bytes;
+        windows = lcd_stats.windows - before.windows;
+    }
+    printf("%-8s %-7s %8lu bytes %5lu windows %8.2f ms bus %8.3f ms host", s->name, banded ? "banded" : "direct",
+           (unsigned long) bytes, (unsigned long) windows, bytes * 8000.0 / LCD_SPI_SPEED, us / 1000.0 / RUNS);
+}
+
+#define LINE_RUNS       200
+
+// one glyph window after another, each glyph a 1 bit bitmap: the rows of the 8 pixel
+// wide nibble layout are just that
+static void line_glyphs(int fc, int bc, const char *s, int len, int x, int y) {
+    static unsigned char blank[LCD_GLYPHS_MAX_W / 8 * 24];
+    const lcd_glyphs_t *g = &lcd_font_main;
+    for (int i = 0; i < len; i++) {
+        int idx = lcd_glyph_index(g, s[i]);
+        const uint8_t *bits = idx < 0 ? blank : lcd_glyph_row0(g, idx);
+        draw_bitmap_spi(x + i * g->width, y, g->width, g->height, 1, fc, bc, (unsigned char *) bits);
+    }
+}
+
+static int line_bench(void) {
+    static const char line[] = "sin(x)*2+cos(3.14159)/7 = 1.234567e+02";
+    int len = (int) strlen(line);
+    lcd_render_sync();
+    printf("\ntext lines of %d characters      bytes commands windows   us host\n", len);
+    for (int run = 0; run < 2; run++) {
+        lcd_stats_t before = lcd_stats;
+        uint64_t t = time_us_64();
+        for (int n = 0; n < LINE_RUNS; n++) {
+            int y = n % 24 * 12;
+            if (run) lcd_print_run(n & 1 ? BLACK : WHITE, n & 1 ? WHITE : BLACK, line, len, 0, y);
+            else line_glyphs(n & 1 ? BLACK : WHITE, n & 1 ? WHITE : BLACK, line, len, 0, y);
+        }
+        lcd_render_sync();
+        t = time_us_64() - t;
+        printf("%-30s %8lu %8lu %7lu %8.2f\n", run ? "one run" : "a glyph at a time",
+               (unsigned long) (lcd_stats.bytes - before.bytes) / LINE_RUNS,
+               (unsigned long) (lcd_stats.commands - before.commands) / LINE_RUNS,
+               (unsigned long) (lcd_stats.windows - before.windows) / LINE_RUNS, (double) t / LINE_RUNS);
+    }
+    line_glyphs(BLACK, WHITE, line, len, 0, 0);
+    lcd_render_sync();
+    grab();
+    lcd_print_run(BLACK, WHITE, line, len, 0, 0);
+    lcd_render_sync();
+    int n = differ();
+    if (n) printf("a run DIFFERS from the glyphs in %d pixels\n", n);
+    return n != 0;
+}
+
+#define WINDOW_BYTES    11      // CASET, PASET and RAMWR with their coordinates
+#define COLMOD_BYTES    2
+
+// every channel off or full on: what the 3 bit format has
+static bool colour_pure(uint32_t c) {
+    for (int i = 0; i < 24; i += 8)
+        if (((c >> i) & 0xFF) != 0 && ((c >> i) & 0xFF) != 0xFF) return false;
+    return true;
+}
+
+static void colmod_rect(int colour) {
+    draw_rect_spi(10, 20, 109, 69, colour);
+}
+
+static void colmod_run(int colour) {
+    lcd_print_run(colour, BLACK, "Pure 3 bit", 10, 8, 100);
+}
+
+// bytes a window of n pixels takes in each format, its COLMOD switch included or not
+static int colmod_check(const char *name, void (*draw)(int), int colour, int n) {
+    uint32_t bytes[2];
+    for (int f = 0; f < 2; f++) {
+        lcd_set_pixel_format(f ? LCD_PIXFMT_AUTO : LCD_PIXFMT_18BIT);
+        lcd_stats_t before = lcd_stats;
+        draw(colour);
+        lcd_render_sync();
+        bytes[f] = lcd_stats.bytes - before.bytes;
+    }
+    lcd_set_pixel_format(LCD_PIXFMT_DEFAULT);
+    uint32_t want18 = n * 3 + WINDOW_BYTES, want3 = colour_pure(colour) ? (n + 1) / 2 + WINDOW_BYTES : want18;
+    bool ok = bytes[0] - want18 <= COLMOD_BYTES && bytes[1] - want3 <= COLMOD_BYTES;
+    printf("%-22s %6d pixels %7lu bytes in 18 bit %7lu auto%s\n", name, n, (unsigned long) bytes[0],
+           (unsigned long) bytes[1], ok ? "" : "  NOT THE EXPECTED SIZE");
+    return !ok;
+}
+
+static int colmod_bench(void) {
+    int bad = 0;
+    lcd_render_sync();
+    printf("\nwindow formats\n");
+    bad |= colmod_check("solid rect, white", colmod_rect, WHITE, 100 * 50);
+    bad |= colmod_check("solid rect, gray", colmod_rect, GRAY, 100 * 50);
+    bad |= colmod_check("glyph run, yellow", colmod_run, YELLOW, 80 * 12);
+    bad |= colmod_check("glyph run, orange", colmod_run, ORANGE, 80 * 12);
+    return bad;
+}
+
+#define TEXT_RUNS       2000
+
+// a screen of text a glyph row at a time, for each of the glyph sets
+static void text_bench(void) {
+    static const struct {
+        const char *name;
+        const lcd_glyphs_t *g;
+        const char *s;
+    } sets[] = {
+        {"main", &lcd_font_main, "sin(x)*2+cos(3.14159)/7 = 1.234567e+02"},
+        {"main_x2", &lcd_font_main_x2, "Reboot Beeps"},
+        {"digits", &lcd_font_digits, "-12.345e7"},
+        {"battery", &lcd_font_battery, "0123456789"},
+    };
+    static unsigned char row[LCD_WIDTH * 3];
+    lcd_render_sync();
+    printf("\ntext rows, %s\n", LCD_USE_DRIVER_TEMPLATES ? "templates" : "generic");
+    for (size_t i = 0; i < count_of(sets); i++) {
+        const lcd_glyphs_t *g = sets[i].g;
+        int len = (int) strlen(sets[i].s), glyph_rows = 0;
+        uint64_t t = time_us_64();
+        for (int n = 0; n < TEXT_RUNS; n++) {
+            for (int r = 0; r < g->height; r++, glyph_rows += len)
+                lcd_text_row(g, n & 1 ? BLACK : WHITE, n & 1 ? WHITE : BLACK, sets[i].s, len, r, row);
+        }
+        printf("%-8s %2dx%-2d %7.2f ns a glyph row\n", sets[i].name, g->width, g->height,
+               (time_us_64() - t) * 1000.0 / glyph_rows);
+    }
+}
+
+#define BITMAP_CASES    400
+
+static uint32_t seed = 12345;
+
+static int rnd(int n) {
+    seed = seed * 1103515245 + 12345;
+    return (int) ((seed >> 8) % (uint32_t) n);
+}
+
+// what draw_bitmap_spi() drew before it stopped dividing for every pixel
+static void bitmap_reference(int x1, int y1, int width, int height, float scale, int fc, int bc,
+                             const unsigned char *bitmap) {
+    int scaled_width = (int) (width * scale), scaled_height = (int) (height * scale);
+    if (x1 >= PANEL_W || y1 >= PANEL_H || x1 + scaled_width < 0 || y1 + scaled_height < 0) return;
+    int XStart = x1 < 0 ? 0 : x1;
+    int XEnd = (x1 + scaled_width - 1) >= PANEL_W ? PANEL_W - 1 : (x1 + scaled_width - 1);
+    int YStart = y1 < 0 ? 0 : y1;
+    int YEnd = (y1 + scaled_height - 1) >= PANEL_H ? PANEL_H - 1 : (y1 + scaled_height - 1);
+    for (int y = YStart; y <= YEnd; y++) {
+        int src_y = (int) ((y - y1) / scale);
+        if (src_y >= height) src_y = height - 1;
+        for (int x = XStart; x <= XEnd; x++) {
+            int src_x = (int) ((x - x1) / scale);
+            if (src_x >= width) src_x = width - 1;
+            int bit_idx = (src_y * width) + src_x;
+            shown[y][x] = ((bitmap[bit_idx / 8] >> (7 - (bit_idx % 8))) & 1) ? fc : bc;
+        }
+    }
+}
+
+static int bitmap_bench(void) {
+    static const float scales[] = {0.8f, 1.0f, 1.5f, 2.0f, 2.3f, 3.0f, 0.5f, 1.0f / 3, 7.1f, 1.25f};
+    static const uint32_t colours[] = {BLACK, WHITE, RED, YELLOW, GRAY, ORANGE, CERULEAN};
+    static unsigned char bits[64 * 64 / 8];
+    int bad = 0, pixels = 0;
+    for (size_t i = 0; i < sizeof(bits); i++) bits[i] = rnd(256);
+    for (int n = 0; n < BITMAP_CASES; n++) {
+        int w = 1 + rnd(63), h = 1 + rnd(63), x = rnd(400) - 60, y = rnd(400) - 60;
+        float scale = n & 2 ? scales[rnd(count_of(scales))] : 0.2f + rnd(10000) / 1000.0f;
+        uint32_t fc = colours[rnd(count_of(colours))], bc = colours[rnd(count_of(colours))];
+        bool banded = n & 1;
+        background();
+        grab();
+        bitmap_reference(x, y, w, h, scale, fc, bc, bits);
+        if (banded) lcd_band_begin();
+        draw_bitmap_spi(x, y, w, h, scale, fc, bc, bits);
+        if (banded) lcd_band_end();
+        lcd_render_sync();
+        int d = differ();
+        pixels += (int) (w * scale) * (int) (h * scale);
+        if (d) {
+            printf("bitmap %dx%d at %d,%d scale %g%s: %d pixels differ\n", w, h, x, y, scale, banded ? " banded" : "", d);
+            bad = 1;
+        }
+    }
+    printf("\nscaled bitmaps: %d cases, %d pixels, %s\n", BITMAP_CASES, pixels,
+           bad ? "DIFFER from the reference" : "same as the reference");
+    return bad;
+}
+
+#define SPRITE_FRAMES   60
+#define TILE            16
+
+static uint8_t tile_px[4][TILE][TILE][3];
+static uint8_t ball_px[2][TILE][TILE][3];
+static uint8_t map[(LCD_HEIGHT / TILE) * (LCD_WIDTH / TILE)];
+static lcd_image_t tiles, ball[2];
+
+static void put(uint8_t *p, uint32_t c) {
+    p[0] = c >> 16;
+    p[1] = (c >> 8) & 0xFF;
+    p[2] = c & 0xFF;
+}
+
+// four tiles in pure colours, in PSRAM; a ball keyed on magenta in pure colours
+// and one in shades, which have to go out in 18 bit
+static void make_assets(void) {
+    static const uint32_t tc[4][2] = {{BLACK, BLUE}, {BLACK, GREEN}, {BLUE, CYAN}, {BLACK, BLACK}};
+    for (int t = 0; t < 4; t++)
+        for (int y = 0; y < TILE; y++)
+            for (int x = 0; x < TILE; x++) put(tile_px[t][y][x], tc[t][(x == 0 || y == 0 || (x + y) % 7 == 0)]);
+    for (int b = 0; b < 2; b++)
+        for (int y = 0; y < TILE; y++)
+            for (int x = 0; x < TILE; x++) {
+                int d = (2 * x - 15) * (2 * x - 15) + (2 * y - 15) * (2 * y - 15);
+                uint32_t c = d > 225 ? MAGENTA : d > 150 ? WHITE : b ? RGB(40 + 12 * y, 20 + 8 * x, 60) : YELLOW;
+                put(ball_px[b][y][x], c);
+            }
+    for (size_t i = 0; i < sizeof(map); i++) map[i] = (i * 7 + i / 20) % 4;
+    lcd_image_init(&tiles, TILE, TILE, 4, LCD_IMAGE_OPAQUE, &tile_px[0][0][0][0]);
+    lcd_image_to_psram(&tiles);
+    for (int b = 0; b < 2; b++) lcd_image_init(&ball[b], TILE, TILE, 1, MAGENTA, &ball_px[b][0][0][0]);
+}
+
+// n balls of kind b bouncing about at different speeds; false if the last frame
+// differs from the whole stage drawn again
+static bool run_sprites(int n, int b, double *bus_ms) {
+    lcd_sprite_t *s[LCD_SPRITE_MAX];
+    int dx[LCD_SPRITE_MAX], dy[LCD_SPRITE_MAX];
+    lcd_stage_open(0, 0, LCD_WIDTH - 1, LCD_HEIGHT - 1, &tiles, map, LCD_WIDTH / TILE, BLACK);
+    for (int i = 0; i < n; i++) {
+        s[i] = lcd_sprite_add(&ball[b], (i * 37) % 300, (i * 71) % 300);
+        dx[i] = 1 + i % 3;
+        dy[i] = 2 - i % 5;
+    }
+    lcd_stage_present();
+    lcd_render_sync();
+    lcd_stats_t before = lcd_stats;
+    uint64_t t = time_us_64();
+    for (int f = 0; f < SPRITE_FRAMES; f++) {
+        for (int i = 0; i < n; i++) {
+            if (s[i]->x + dx[i] < -8 || s[i]->x + dx[i] > LCD_WIDTH - 8) dx[i] = -dx[i];
+            if (s[i]->y + dy[i] < -8 || s[i]->y + dy[i] > LCD_HEIGHT - 8) dy[i] = -dy[i];
+            s[i]->x += dx[i];
+            s[i]->y += dy[i];
+        }
+        lcd_stage_present();
+    }
+    lcd_render_sync();
+    uint64_t us = time_us_64() - t;
+    uint32_t bytes = (lcd_stats.bytes - before.bytes) / SPRITE_FRAMES;
+    uint32_t windows = (lcd_stats.windows - before.windows) / SPRITE_FRAMES;
+    *bus_ms = bytes * 8000.0 / LCD_SPI_SPEED;
+    printf("%2d %-6s %8lu bytes %5lu windows %8.2f ms bus %6.0f fps %8.3f ms host\n", n, b ? "shaded" : "pure",
+           (unsigned long) bytes, (unsigned long) windows, *bus_ms, 1000 / *bus_ms, us / 1000.0 / SPRITE_FRAMES);
+    grab();
+    lcd_stage_invalidate(0, 0, LCD_WIDTH - 1, LCD_HEIGHT - 1);
+    lcd_stage_present();
+    lcd_render_sync();
+    lcd_stage_close();
+    return !differ();
+}
+
+static int sprite_bench(void) {
+    int bad = 0;
+    make_assets();
+    printf("\nsprites a frame, %d frames\n", SPRITE_FRAMES);
+    for (int b = 0; b < 2; b++) {
+        double ms = 0;
+        for (int n = 1; n <= LCD_SPRITE_MAX; n *= 2) {
+            if (!run_sprites(n, b, &ms)) {
+                printf("DIFFERS from a full redraw\n");
+                bad = 1;
+            }
+        }
+        // sprites that do not overlap cost about the same each
+        double each = ms / LCD_SPRITE_MAX;
+        printf("%s: about %d sprites at 60 fps, %d at 30 fps before the bus is the limit\n", b ? "shaded" : "pure",
+               (int) (1000.0 / 60 / each), (int) (1000.0 / 30 / each));
+    }
+    return bad;
+}
+
+uint16_t sim_poll_key(void) {
+    return 0;
+}
+
+void sim_finish(const char *why) {
+    exit(0);
+}
+
+static const char *const plot_exprs[] = {"sin(x)", "x^2", "x^3/4", "tan(x)", "x/2+1"};
+
+// the graph tab's plotter before it had spans: every pixel of a step on its own, each
+// flushed to go out as a window of its own as it did before the PIXELS executor
+// merged neighbours
+static void plot_pixels(const char *expr, int colour) {
+    double x_val;
+    te_variable vars[] = {{"x", &x_val}};
+    te_expr *e = te_compile(expr, vars, 1, 0);
+    if (!e) return;
+    int last_sy = -1;
+    for (int sx = 0; sx < 320; sx++) {
+        x_val = (sx - 160) / 16.0;
+        double yv = te_eval(e);
+        if (isnan(yv) || isinf(yv)) {
+            last_sy = -1;
+            continue;
+        }
+        int sy = 154 - (int) (yv * 16);
+        if (sy >= 14 && sy <= 294) {
+            if (last_sy != -1) {
+                int ys = last_sy < sy ? last_sy : sy, ye = last_sy < sy ? sy : last_sy;
+                for (int y = ys; y <= ye; y++) {
+                    if (y < 14 || y > 294) continue;
+                    spi_draw_pixel(sx, y, colour);
+                    lcd_render_flush();
+                }
+            } else {
+                spi_draw_pixel(sx, sy, colour);
+                lcd_render_flush();
+            }
+            last_sy = sy;
+        } else {
+            last_sy = -1;
+        }
+    }
+    te_free(e);
+}
+
+// the bus traffic of curve 0 alone, already worked out, on a cleared plot
+static void plot_traffic(const char *expr, bool spans, uint32_t *bytes, uint32_t *windows) {
+    draw_rect_spi(0, 0, 320, 294, BLACK);
+    lcd_render_sync();
+    lcd_stats_t before = lcd_stats;
+    if (spans) graph_draw(0, RED);
+    else plot_pixels(expr, RED);
+    lcd_render_sync();
+    *bytes = lcd_stats.bytes - before.bytes;
+    *windows = lcd_stats.windows - before.windows;
+}
+
+static void plot_bench(void) {
+    uint32_t total[2] = {0, 0};
+    graph_set_adaptive(false);
+    printf("\nplotted curve   pixel by pixel: bytes windows   spans: bytes windows  pixels differ\n");
+    for (size_t i = 0; i < count_of(plot_exprs); i++) {
+        uint32_t bytes[2], windows[2];
+        graph_forget(0);
+        graph_set(0, plot_exprs[i]);
+        plot_traffic(plot_exprs[i], false, &bytes[0], &windows[0]);
+        grab();
+        plot_traffic(plot_exprs[i], true, &bytes[1], &windows[1]);
+        printf("%-14s %22lu %7lu %13lu %7lu %14d\n", plot_exprs[i], (unsigned long) bytes[0], (unsigned long) windows[0],
+               (unsigned long) bytes[1], (unsigned long) windows[1], differ());
+        total[0] += bytes[0];
+        total[1] += bytes[1];
+    }
+    printf("%-14s %22lu %21lu\n", "total", (unsigned long) total[0], (unsigned long) total[1]);
+    graph_forget(0);
+    graph_set_adaptive(true);
+}
+
+#define GRAPH_RUNS      10
+
+static const char *const graph_exprs[] = {
+    "sin(x)", "x*x/4", "3", "exp(x)", "sqrt(x)+exp(-x*x)", "floor(x)", "tan(x)", "1/(x-1)",
+    "sin(1/x)", "abs(x)-2",
+};
+
+// curve 0 worked out afresh in GRAPH_RUNS batches of GRAPH_RUNS, then drawn alone; the
+// time is for one, in the quickest batch
+static double graph_curve(const char *expr, bool adaptive, uint32_t points[GRAPH_BACKENDS], uint32_t *bounds) {
+    uint64_t best = UINT64_MAX;
+    graph_set_adaptive(adaptive);
+    for (int b = 0; b < GRAPH_RUNS; b++) {
+        uint64_t t = time_us_64();
+        for (int i = 0; i < GRAPH_RUNS; i++) {
+            graph_forget(0);
+            graph_set(0, expr);
+        }
+        t = time_us_64() - t;
+        if (t < best) best = t;
+    }
+    graph_stats(0, points, bounds);
+    draw_rect_spi(0, 0, 320, 294, BLACK);
+    graph_draw(0, RED);
+    lcd_render_sync();
+    return best / 1000.0 / GRAPH_RUNS;
+}
+
+static void graph_bench(void) {
+    for (int zoom = 0; zoom < 2; zoom++) {
+        if (zoom) {
+            graph_zoom(false);
+            graph_zoom(false);
+        }
+        printf("\ncurve, %d pixels a unit  every column   ms  adaptive: points (float fixed) bounds   ms\n",
+               GRAPH_SCALE >> zoom * 2);
+        for (size_t i = 0; i < count_of(graph_exprs); i++) {
+            uint32_t points[GRAPH_BACKENDS], every[GRAPH_BACKENDS], bounds;
+            double t_every = graph_curve(graph_exprs[i], false, every, &bounds);
+            grab();
+            double t_adaptive = graph_curve(graph_exprs[i], true, points, &bounds);
+            printf("%-24s %6lu %9.3f %16lu (%5lu %5lu) %6lu %6.3f  %5d pixels differ\n", graph_exprs[i],
+                   (unsigned long) (every[0] + every[1] + every[2]), t_every,
+                   (unsigned long) (points[0] + points[1] + points[2]), (unsigned long) points[GRAPH_FLOAT],
+                   (unsigned long) points[GRAPH_FIXED], (unsigned long) bounds, t_adaptive, differ());
+        }
+    }
+}
+
+#define BACKEND_RUNS    200
+
+static const char *const backend_exprs[] = {
+    "sin(x)", "x*x/4", "x^3-2*x", "cos(3*x)*x", "sqrt(x)+exp(-x*x)", "floor(x)", "tan(x)", "1/(x-1)",
+    "ln(x)", "2^x", "atan2(x,2)", "abs(x)-2",
+};
+
+static const char *const backend_names[GRAPH_BACKENDS] = {"double", "float", "fixed"};
+
+static double eval_with(const graph_expr_t *p, int k, double x) {
+    if (k == GRAPH_FIXED) return graph_expr_evalq(p, x);
+    if (k == GRAPH_FLOAT) return graph_expr_evalf(p, x);
+    return graph_expr_eval(p, x);
+}
+
+// Each backend on the columns of the starting view: the time a point, the most it is
+// off from double there and the most its bound allows, and the columns where that is
+// under half a pixel so the graph would use it. Being off by more than the bound at
+// any column is a failure.
+static int backend_bench(void) {
+    int bad = 0;
+    printf("\nbackends, %d pixels a unit    ns a point      off by     bound  columns\n", GRAPH_SCALE);
+    for (size_t i = 0; i < count_of(backend_exprs); i++) {
+        graph_expr_t p;
+        if (!graph_expr_compile(&p, backend_exprs[i])) continue;
+        for (int k = 0; k < GRAPH_BACKENDS; k++) {
+            volatile double sink = 0;
+            uint64_t t = time_us_64();
+            for (int r = 0; r < BACKEND_RUNS; r++) {
+                for (int sx = 0; sx < GRAPH_COLS; sx++) sink += eval_with(&p, k, (sx - GRAPH_ORIGIN_X) * (1.0 / GRAPH_SCALE));
+            }
+            t = time_us_64() - t;
+            double off = 0, most = 0;
+            int bounded = 0, usable = 0, wrong = 0;
+            for (int sx = 0; sx < GRAPH_COLS; sx++) {
+                double x = (sx - GRAPH_ORIGIN_X) * (1.0 / GRAPH_SCALE);
+                graph_bound_t b = graph_expr_bound(&p, x, x);
+                double want = graph_expr_eval(&p, x), got = eval_with(&p, k, x);
+                if (!b.cont || !isfinite(want) || isinf(b.err[k])) continue;
+                double e = fabs(got - want);
+                bounded++;
+                if (!(e <= b.err[k])) wrong++;
+                if (e > off) off = e;
+                if (b.err[k] > most) most = b.err[k];
+                if (b.err[k] < 0.5 / GRAPH_SCALE) usable++;
+            }
+            printf("%-24s %-6s %8.1f", k ? "" : backend_exprs[i], backend_names[k], t * 1000.0 / BACKEND_RUNS / GRAPH_COLS);
+            if (bounded) printf(" %11.3g %9.3g %8d\n", off, most, usable);
+            else printf(" %11s %9s %8d\n", "-", "-", 0);
+            if (wrong) {
+                printf("OFF BY MORE THAN THE BOUND at %d columns\n", wrong);
+                bad = 1;
+            }
+        }
+    }
+    return bad;
+}
+
+#define QUEUE_COMMANDS  2000000
+
+static lcd_queue_t stress_queue;
+
+// the consumer's side: each command has to come out whole and in the order it went in
+static void *queue_consumer(void *arg) {
+    uint32_t *bad = arg;
+    for (uint32_t want = 0; want < QUEUE_COMMANDS;) {
+        const lcd_cmd_t *c = lcd_queue_peek(&stress_queue);
+        if (!c) {
+            sched_yield();
+            continue;
+        }
+        if (c->fc != want || c->bc != ~want || c->x1 != (int16_t) want || c->len != (uint8_t) want ||
+            c->pts[LCD_CMD_PIXELS_MAX - 1].y != (int16_t) (want >> 3))
+            (*bad)++;
+        lcd_queue_release(&stress_queue);
+        want++;
+    }
+    return NULL;
+}
+
+static int queue_bench(void) {
+    uint32_t bad = 0;
+    pthread_t consumer;
+    pthread_create(&consumer, NULL, queue_consumer, &bad);
+    uint64_t t = time_us_64();
+    for (uint32_t n = 0; n < QUEUE_COMMANDS; n++) {
+        lcd_cmd_t *c;
+        while (!(c = lcd_queue_reserve(&stress_queue))) sched_yield();
+        c->fc = n;
+        c->bc = ~n;
+        c->x1 = (int16_t) n;
+        c->len = (uint8_t) n;
+        c->pts[LCD_CMD_PIXELS_MAX - 1].y = (int16_t) (n >> 3);
+        lcd_queue_publish(&stress_queue);
+    }
+    pthread_join(consumer, NULL);
+    t = time_us_64() - t;
+    printf("\nrender queue: %d commands between two threads, %.1f ns each, %lu out of order or torn\n",
+           QUEUE_COMMANDS, t * 1000.0 / QUEUE_COMMANDS, (unsigned long) bad);
+    return bad != 0 || !lcd_queue_empty(&stress_queue);
+}
+
+static uint8_t sunk[2048];
+static uint32_t sunk_len;
+static lcd_fence_t called[8];
+static bool called_cs[8];
+static int calls;
+
+static void dma_sink(const uint8_t *src, uint32_t len) {
+    if (sunk_len + len <= sizeof(sunk)) memcpy(sunk + sunk_len, src, len);
+    sunk_len += len;
+}
+
+// a job's callback runs once its fence has passed and before the next one's has
+static void dma_called(lcd_fence_t fence, void *arg) {
+    if (calls < (int) count_of(called)) {
+        called[calls] = lcd_dma_done(fence) && !lcd_dma_done(fence + 1) ? fence : 0;
+        called_cs[calls] = gpio_get(Pico_LCD_CS);
+    }
+    calls++;
+}
+
+static int dma_bench(void) {
+    static const uint8_t head[5] = {1, 2, 3, 4, 5}, tail[3] = {0xA5, 0x5A, 0xC3};
+    uint8_t want[sizeof(sunk)];
+    uint32_t n = 0;
+    int bad = 0;
+    lcd_render_sync();
+    lcd_dma_mock_set_sink(dma_sink);
+    sunk_len = calls = 0;
+    lcd_spi_lower_cs();
+
+    // two colours, one for each fill pattern: a third would wait for the older one
+    lcd_fence_t f[5];
+    f[0] = lcd_dma_send_cb(head, sizeof(head), 0, dma_called, NULL);
+    f[1] = lcd_dma_fill(0x123456, LCD_DMA_FILL_PIXELS * 2 + 40, 0);
+    f[2] = lcd_dma_fill(0x123456, 7, 0);
+    f[3] = lcd_dma_fill_bytes(0x3C, 11, 0);
+    f[4] = lcd_dma_send_cb(tail, sizeof(tail), LCD_DMA_END, dma_called, NULL);
+    memcpy(want + n, head, sizeof(head));
+    n += sizeof(head);
+    for (int i = 0; i < LCD_DMA_FILL_PIXELS * 2 + 40 + 7; i++, n += 3) memcpy(want + n, "\x12\x34\x56", 3);
+    memset(want + n, 0x3C, 11);
+    n += 11;
+    memcpy(want + n, tail, sizeof(tail));
+    n += sizeof(tail);
+
+    // nothing moves until stepped; then fences pass one after another
+    bad |= lcd_dma_mock_pending() != 5 || lcd_dma_done(f[0]) || calls != 0;
+    int steps = 0;
+    while (lcd_dma_mock_step()) {
+        steps++;
+        for (int i = 1; i < 5; i++) bad |= lcd_dma_done(f[i]) && !lcd_dma_done(f[i - 1]);
+        bad |= gpio_get(Pico_LCD_CS) != lcd_dma_done(f[4]);
+    }
+    lcd_dma_wait_idle();
+    bad |= lcd_dma_mock_pending() != 0 || !lcd_dma_done(f[4]);
+    bad |= calls != 2 || called[0] != f[0] || called_cs[0] || called[1] != f[4] || !called_cs[1];
+    bad |= sunk_len != n || memcmp(sunk, want, n) != 0;
+    lcd_dma_mock_set_sink(NULL);
+    printf("\ntransfer engine: 5 jobs, %lu bytes in %d blocks, %d callbacks%s\n", (unsigned long) sunk_len, steps,
+           calls, bad ? "  WRONG BYTES OR ORDER" : "");
+    return bad;
+}
+
+#define SCROLL_ROWS     300
+
+// a colour for each row the panel has, all of them kept by 18 bit
+static uint32_t row_colour(int row) {
+    return RGB((row & 63) << 2, (row >> 6) << 2, 0x80);
+}
+
+static int scroll_bench(void) {
+    static const int steps[] = {1, 12, 299, -5, 150, -37};
+    static uint32_t gram[LCD_PANEL_ROWS], logical[SCROLL_ROWS], moved[SCROLL_ROWS];
+    int bad = 0, keep = lcd_scroll_rows();
+    uint32_t bc = lcd_console_bcolour();
+    lcd_scroll_define(SCROLL_ROWS);
+    for (int y = 0; y < LCD_HEIGHT; y++) draw_rect_spi(0, y, 319, y, row_colour(y));
+    lcd_render_sync();
+    for (int r = 0; r < LCD_PANEL_ROWS; r++) gram[r] = row_colour(r);
+    for (int y = 0; y < SCROLL_ROWS; y++) logical[y] = row_colour(y);
+    for (size_t i = 0; i < count_of(steps); i++) {
+        int n = steps[i];
+        scroll_lcd_spi(n);
+        lcd_render_sync();
+        // rows move up by n and the ones brought into view are cleared to the console's
+        // background, on the panel row each logical one is shown on now
+        for (int y = 0; y < SCROLL_ROWS; y++) {
+            bool cleared = n > 0 ? y >= SCROLL_ROWS - n : y < -n;
+            moved[y] = cleared ? bc : logical[(y + n + SCROLL_ROWS) % SCROLL_ROWS];
+            if (cleared) gram[lcd_scroll_phys_y(y)] = bc;
+        }
+        memcpy(logical, moved, sizeof(logical));
+        for (int line = 0; line < PANEL_H; line++) {
+            int row = lcd_scroll_mock_shown_row(0, SCROLL_ROWS, lcd_scroll_offset(), line);
+            uint32_t c = panel_pixel(160, line) & 0xFCFCFC;
+            bad |= c != (gram[row] & 0xFCFCFC) || (line < SCROLL_ROWS && c != (logical[line] & 0xFCFCFC));
+        }
+    }
+    // drawing goes to the row the logical one is shown on now
+    draw_rect_spi(0, 10, 319, 10, WHITE);
+    lcd_render_sync();
+    bad |= panel_pixel(160, 10) != WHITE || (panel_pixel(160, 11) & 0xFCFCFC) != (logical[11] & 0xFCFCFC);
+    printf("\nscrolling: %d steps over %d rows, shown rows %s\n", (int) count_of(steps), SCROLL_ROWS,
+           bad ? "DIFFER FROM THE MODEL" : "match the model");
+    lcd_scroll_define(keep);
+    return bad;
+}
+
+#define SHOT_MODEL      "bench_panel.bmp"
+#define SHOT_READBACK   "bench_screenshot.bmp"
+
+static uint8_t *read_file(const char *path, long *size) {
+    FILE *f = fopen(path, "rb");
+    uint8_t *p = NULL;
+    if (f && fseek(f, 0, SEEK_END) == 0 && (*size = ftell(f)) > 0 && fseek(f, 0, SEEK_SET) == 0 &&
+        (p = malloc(*size)) && fread(p, 1, *size, f) != (size_t) *size) {
+        free(p);
+        p = NULL;
+    }
+    if (f) fclose(f);
+    return p;
+}
+
+static uint32_t get_le(const uint8_t *p, int n) {
+    uint32_t v = 0;
+    for (int i = n - 1; i >= 0; i--) v = v << 8 | p[i];
+    return v;
+}
+
+// decodes the file as the 24 bit top-down BMP it should be, pixel by pixel
+static int bmp_bench(void) {
+    int bad = 0, wrong = 0;
+    long size = 0, shot_size = 0;
+    scene_result();
+    scroll_lcd_spi(37);
+    lcd_render_sync();
+    bad |= !panel_write_bmp(SHOT_MODEL) || !lcd_screenshot(SHOT_READBACK);
+    uint8_t *bmp = read_file(SHOT_MODEL, &size), *shot = read_file(SHOT_READBACK, &shot_size);
+    int stride = lcd_bmp_stride(PANEL_W);
+    if (!bmp || size != LCD_BMP_HEADER + (long) stride * PANEL_H || bmp[0] != 'B' || bmp[1] != 'M' ||
+        get_le(bmp + 10, 4) != LCD_BMP_HEADER || get_le(bmp + 18, 4) != PANEL_W ||
+        (int32_t) get_le(bmp + 22, 4) != -PANEL_H || get_le(bmp + 28, 2) != 24) {
+        bad = 1;
+    } else {
+        for (int y = 0; y < PANEL_H; y++)
+            for (int x = 0; x < PANEL_W; x++) {
+                const uint8_t *px = bmp + LCD_BMP_HEADER + y * stride + x * 3;
+                uint32_t c = RGB(px[2], px[1], px[0]);
+                wrong += (c & 0xFCFCFC) != (panel_pixel(x, y) & 0xFCFCFC);
+            }
+    }
+    bool same = bmp && shot && size == shot_size && memcmp(bmp, shot, size) == 0;
+    printf("\nscreenshots: %ld bytes, %d pixels differ from the panel, %s lcd_screenshot()\n", size, wrong,
+           same ? "same file as" : "NOT THE SAME FILE AS");
+    free(bmp);
+    free(shot);
+    remove(SHOT_MODEL);
+    remove(SHOT_READBACK);
+    lcd_clear();
+    lcd_render_sync();
+    return bad || wrong || !same;
+}
+
+int main(void) {
+    int bad = 0;
+    lcd_init();
+    for (size_t i = 0; i < count_of(scenes); i++) {
+        measure(&scenes[i], false);
+        printf("\n");
+        grab();
+        measure(&scenes[i], true);
+        int n = differ();
+        printf("  %s\n", n ? "DIFFERS" : "same pixels");
+        if (n) {
+            printf("%d pixels differ\n", n);
+            bad = 1;
+        }
+    }
+    bad |= line_bench();
+    bad |= colmod_bench();
+    text_bench();
+    bad |= bitmap_bench();
+    bad |= sprite_bench();
+    bad |= queue_bench();
+    bad |= dma_bench();
+    bad |= scroll_bench();
+    bad |= bmp_bench();
+    plot_bench();
+    graph_bench();
+    bad |= backend_bench();
+    return bad;
+}
@@ -0,0 +1,280 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "pico/stdlib.h"
+#include "pico/bootrom.h"
+#include "hardware/spi.h"
+#include "hardware/i2c.h"
+#include "hardware/irq.h"
+#include "hardware/pwm.h"
+#include "blockdevice/sd.h"
+#include "filesystem/vfs.h"
+
+#include "lcdspi.h"
+#include "i2ckbd.h"
+#include "panel.h"
+#include "sim.h"
+
+#define SYS_CLOCK_HZ 133000000
+
+// instances are only compared, never looked into
+static int instances[6];
+spi_inst_t *spi0 = (spi_inst_t *) &instances[0], *spi1 = (spi_inst_t *) &instances[1];
+i2c_inst_t *i2c0 = (i2c_inst_t *) &instances[2], *i2c1 = (i2c_inst_t *) &instances[3];
+uart_inst_t *uart0 = (uart_inst_t *) &instances[4], *uart1 = (uart_inst_t *) &instances[5];
+
+uint get_core_num(void) {
+    return 0;
+}
+
+// clock
+
+uint64_t time_us_64(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+uint32_t time_us_32(void) {
+    return (uint32_t) time_us_64();
+}
+
+bool set_sys_clock_khz(uint32_t khz, bool required) {
+    return true;
+}
+
+// interrupts and PWM: the wrap interrupt is the only one the firmware installs
+
+static irq_handler_t handlers[32];
+static bool irq_on[32];
+static float pwm_div = 1.0f;
+static uint16_t pwm_wrap = 0xFFFF;
+static bool pwm_irq = false;
+static uint16_t level_a = 0;
+static uint32_t edges = 0, sound_us = 0;
+static uint64_t pwm_phase = 0;      // interrupts owed, in units of 1/1000000
+
+void irq_set_exclusive_handler(uint num, irq_handler_t handler) {
+    handlers[num] = handler;
+}
+
+void irq_set_enabled(uint num, bool enabled) {
+    irq_on[num] = enabled;
+}
+
+uint pwm_gpio_to_slice_num(uint gpio) {
+    return (gpio >> 1) & 7;
+}
+
+pwm_config pwm_get_default_config(void) {
+    return (pwm_config) {1.0f, 0xFFFF};
+}
+
+void pwm_config_set_clkdiv(pwm_config *c, float div) {
+    c->div = div;
+}
+
+void pwm_config_set_wrap(pwm_config *c, uint16_t wrap) {
+    c->wrap = wrap;
+}
+
+void pwm_init(uint slice, pwm_config *c, bool start) {
+    pwm_div = c->div;
+    pwm_wrap = c->wrap;
+}
+
+void pwm_set_chan_level(uint slice, uint chan, uint16_t level) {
+    if (chan != PWM_CHAN_A) return;
+    if ((level != 0) != (level_a != 0)) edges++;
+    level_a = level;
+}
+
+void pwm_clear_irq(uint slice) {
+}
+
+void pwm_set_irq_enabled(uint slice, bool enabled) {
+    pwm_irq = enabled;
+}
+
+static void run_pwm(uint64_t us) {
+    if (!pwm_irq || !irq_on[PWM_IRQ_WRAP] || !handlers[PWM_IRQ_WRAP]) return;
+    uint64_t rate = (uint64_t) (SYS_CLOCK_HZ / (pwm_div * (pwm_wrap + 1)));
+    pwm_phase += rate * us;
+    uint32_t before = edges;
+    for (; pwm_phase >= 1000000; pwm_phase -= 1000000) handlers[PWM_IRQ_WRAP]();
+    if (edges != before) sound_us += us;
+}
+
+void hal_sound_take(uint32_t *e, uint32_t *us) {
+    *e = edges;
+    *us = sound_us;
+    edges = sound_us = 0;
+}
+
+void sleep_us(uint64_t us) {
+    run_pwm(us);
+}
+
+void sleep_ms(uint32_t ms) {
+    run_pwm((uint64_t) ms * 1000);
+}
+
+// GPIO: DC and CS of the LCD go to the panel model; every pin reads back as last set
+
+static bool gpio_level[32];
+
+void gpio_init(uint gpio) {
+}
+
+void gpio_set_dir(uint gpio, bool out) {
+}
+
+void gpio_put(uint gpio, bool value) {
+    gpio_level[gpio & 31] = value;
+    if (gpio == Pico_LCD_DC) panel_dc(value);
+    else if (gpio == Pico_LCD_CS) panel_cs(value);
+}
+
+bool gpio_get(uint gpio) {
+    return gpio_level[gpio & 31];
+}
+
+void gpio_set_function(uint gpio, int fn) {
+}
+
+void gpio_set_pulls(uint gpio, bool up, bool down) {
+}
+
+void gpio_pull_up(uint gpio) {
+}
+
+void gpio_pull_down(uint gpio) {
+}
+
+void gpio_xor_mask(uint32_t mask) {
+}
+
+void gpio_set_drive_strength(uint gpio, int drive) {
+}
+
+void gpio_set_input_hysteresis_enabled(uint gpio, bool enabled) {
+}
+
+// SPI
+
+// writes go straight to the panel model, so the FIFO is always empty and idle
+static spi_hw_t spi_regs = {.sr = SPI_SSPSR_TFE_BITS};
+
+uint spi_init(spi_inst_t *spi, uint baudrate) {
+    if (spi == spi1) panel_reset();
+    return baudrate;
+}
+
+uint spi_set_baudrate(spi_inst_t *spi, uint baudrate) {
+    return baudrate;
+}
+
+spi_hw_t *spi_get_hw(spi_inst_t *spi) {
+    return &spi_regs;
+}
+
+bool spi_is_writable(spi_inst_t *spi) {
+    return true;
+}
+
+bool spi_is_readable(spi_inst_t *spi) {
+    return false;
+}
+
+int spi_write_blocking(spi_inst_t *spi, const uint8_t *src, size_t len) {
+    if (spi == spi1) panel_write(src, len);
+    return (int) len;
+}
+
+int spi_read_blocking(spi_inst_t *spi, uint8_t repeated_tx, uint8_t *dst, size_t len) {
+    if (spi == spi1) panel_read(dst, len);
+    else memset(dst, 0xFF, len);
+    return (int) len;
+}
+
+int spi_write_read_blocking(spi_inst_t *spi, const uint8_t *src, uint8_t *dst, size_t len) {
+    if (spi == spi1) {
+        panel_write(src, len);
+        memset(dst, 0, len);
+    }
+    return (int) len;
+}
+
+// I2C: the keyboard controller at I2C_KBD_ADDR, register 0x09 is the key FIFO,
+// 0x0B the battery and 0x0A the backlight
+
+static uint8_t kbd_reg = 0;
+
+uint i2c_init(i2c_inst_t *i2c, uint baudrate) {
+    return baudrate;
+}
+
+int i2c_write_timeout_us(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len,
+                         bool nostop, uint timeout_us) {
+    if (i2c != I2C_KBD_MOD || addr != I2C_KBD_ADDR) return PICO_ERROR_TIMEOUT;
+    kbd_reg = src[0] & 0x7F;
+    return (int) len;
+}
+
+int i2c_read_timeout_us(i2c_inst_t *i2c, uint8_t addr, uint8_t *dst, size_t len,
+                        bool nostop, uint timeout_us) {
+    if (i2c != I2C_KBD_MOD || addr != I2C_KBD_ADDR) return PICO_ERROR_TIMEOUT;
+    uint16_t v = 0;
+    if (kbd_reg == 0x09) v = sim_poll_key();
+    else if (kbd_reg == 0x0B) v = 80 << 8 | 0x0B;     // 80% charged
+    else v = kbd_reg;
+    memset(dst, 0, len);
+    memcpy(dst, &v, len < 2 ? len : 2);
+    return (int) len;
+}
+
+// stdio and UART: stdout is the console
+
+bool stdio_init_all(void) {
+    return true;
+}
+
+int getchar_timeout_us(uint32_t timeout_us) {
+    return PICO_ERROR_TIMEOUT;
+}
+
+uint uart_init(uart_inst_t *uart, uint baudrate) {
+    return baudrate;
+}
+
+void uart_set_format(uart_inst_t *uart, uint data_bits, uint stop_bits, int parity) {
+}
+
+void uart_set_fifo_enabled(uart_inst_t *uart, bool enabled) {
+}
+
+void reset_usb_boot(uint32_t gpio_mask, uint32_t disable_mask) {
+    sim_finish("reboot");
+}
+
+// SD card and file system: the host file system, see filesystem/vfs.h
+
+static int fs_dummy;
+
+blockdevice_t *blockdevice_sd_create(spi_inst_t *spi, uint mosi, uint miso, uint sclk, uint cs,
+                                     uint32_t hz, bool crc) {
+    return (blockdevice_t *) &fs_dummy;
+}
+
+filesystem_t *filesystem_fat_create(void) {
+    return (filesystem_t *) &fs_dummy;
+}
+
+int fs_mount(const char *path, filesystem_t *fs, blockdevice_t *dev) {
+    return 0;
+}
+
+int fs_format(filesystem_t *fs, blockdevice_t *dev) {
+    return 0;
+}
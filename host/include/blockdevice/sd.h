@@ -0,0 +1,11 @@
+#ifndef HOST_BLOCKDEVICE_SD_H
+#define HOST_BLOCKDEVICE_SD_H
+
+#include "hardware/spi.h"
+
+typedef struct blockdevice blockdevice_t;
+
+extern blockdevice_t *blockdevice_sd_create(spi_inst_t *spi, uint mosi, uint miso, uint sclk, uint cs,
+                                            uint32_t hz, bool crc);
+
+#endif
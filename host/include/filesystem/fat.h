@@ -0,0 +1,8 @@
+#ifndef HOST_FILESYSTEM_FAT_H
+#define HOST_FILESYSTEM_FAT_H
+
+typedef struct filesystem filesystem_t;
+
+extern filesystem_t *filesystem_fat_create(void);
+
+#endif
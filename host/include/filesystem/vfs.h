@@ -0,0 +1,14 @@
+#ifndef HOST_FILESYSTEM_VFS_H
+#define HOST_FILESYSTEM_VFS_H
+
+#include <sys/stat.h>
+
+#include "blockdevice/sd.h"
+#include "filesystem/fat.h"
+
+// The simulator runs inside its file directory and COYOTE_DIR is relative, so the
+// ordinary C library calls the firmware makes land there; mounting always works.
+extern int fs_mount(const char *path, filesystem_t *fs, blockdevice_t *dev);
+extern int fs_format(filesystem_t *fs, blockdevice_t *dev);
+
+#endif
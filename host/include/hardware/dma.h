@@ -0,0 +1,8 @@
+#ifndef HOST_HARDWARE_DMA_H
+#define HOST_HARDWARE_DMA_H
+
+#include "pico/platform.h"
+
+// lcd_dma.c queues jobs into its own mock on the host and uses no channels
+
+#endif
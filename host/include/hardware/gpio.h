@@ -0,0 +1,25 @@
+#ifndef HOST_HARDWARE_GPIO_H
+#define HOST_HARDWARE_GPIO_H
+
+#include "pico/platform.h"
+
+enum { GPIO_FUNC_SPI = 1, GPIO_FUNC_UART = 2, GPIO_FUNC_I2C = 3, GPIO_FUNC_PWM = 4, GPIO_FUNC_SIO = 5 };
+
+#define GPIO_OUT 1
+#define GPIO_IN 0
+#define GPIO_DRIVE_STRENGTH_12MA 3
+
+extern void gpio_init(uint gpio);
+extern void gpio_set_dir(uint gpio, bool out);
+// the LCD DC and CS pins are passed on to the panel model
+extern void gpio_put(uint gpio, bool value);
+extern bool gpio_get(uint gpio);
+extern void gpio_set_function(uint gpio, int fn);
+extern void gpio_set_pulls(uint gpio, bool up, bool down);
+extern void gpio_pull_up(uint gpio);
+extern void gpio_pull_down(uint gpio);
+extern void gpio_xor_mask(uint32_t mask);
+extern void gpio_set_drive_strength(uint gpio, int drive);
+extern void gpio_set_input_hysteresis_enabled(uint gpio, bool enabled);
+
+#endif
@@ -0,0 +1,16 @@
+#ifndef HOST_HARDWARE_I2C_H
+#define HOST_HARDWARE_I2C_H
+
+#include "pico/platform.h"
+
+typedef struct i2c_inst i2c_inst_t;
+extern i2c_inst_t *i2c0, *i2c1;
+
+// i2c1 answers like the PicoCalc keyboard controller, fed from the key script
+extern uint i2c_init(i2c_inst_t *i2c, uint baudrate);
+extern int i2c_write_timeout_us(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len,
+                                bool nostop, uint timeout_us);
+extern int i2c_read_timeout_us(i2c_inst_t *i2c, uint8_t addr, uint8_t *dst, size_t len,
+                               bool nostop, uint timeout_us);
+
+#endif
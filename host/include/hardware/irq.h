@@ -0,0 +1,15 @@
+#ifndef HOST_HARDWARE_IRQ_H
+#define HOST_HARDWARE_IRQ_H
+
+#include "pico/platform.h"
+
+#define PWM_IRQ_WRAP 4
+#define DMA_IRQ_0 11
+#define DMA_IRQ_1 12
+
+typedef void (*irq_handler_t)(void);
+
+extern void irq_set_exclusive_handler(uint num, irq_handler_t handler);
+extern void irq_set_enabled(uint num, bool enabled);
+
+#endif
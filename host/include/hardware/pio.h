@@ -0,0 +1,8 @@
+#ifndef HOST_HARDWARE_PIO_H
+#define HOST_HARDWARE_PIO_H
+
+#include "pico/platform.h"
+
+// PSRAM is plain memory on the host (lcd_psram.c), nothing drives a PIO
+
+#endif
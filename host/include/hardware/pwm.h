@@ -0,0 +1,25 @@
+#ifndef HOST_HARDWARE_PWM_H
+#define HOST_HARDWARE_PWM_H
+
+#include "pico/platform.h"
+#include "hardware/irq.h"
+
+typedef struct {
+    float div;
+    uint16_t wrap;
+} pwm_config;
+
+enum { PWM_CHAN_A, PWM_CHAN_B };
+
+// The wrap interrupt is run from sleep_ms() at the rate the configuration gives
+// at 133MHz, and the levels it sets are recorded as the sound output.
+extern uint pwm_gpio_to_slice_num(uint gpio);
+extern pwm_config pwm_get_default_config(void);
+extern void pwm_config_set_clkdiv(pwm_config *c, float div);
+extern void pwm_config_set_wrap(pwm_config *c, uint16_t wrap);
+extern void pwm_init(uint slice, pwm_config *c, bool start);
+extern void pwm_set_chan_level(uint slice, uint chan, uint16_t level);
+extern void pwm_clear_irq(uint slice);
+extern void pwm_set_irq_enabled(uint slice, bool enabled);
+
+#endif
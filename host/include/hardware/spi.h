@@ -0,0 +1,27 @@
+#ifndef HOST_HARDWARE_SPI_H
+#define HOST_HARDWARE_SPI_H
+
+#include "pico/platform.h"
+
+typedef struct {
+    volatile uint32_t cr0, cr1, dr, sr, cpsr, imsc, ris, mis, icr, dmacr;
+} spi_hw_t;
+
+typedef struct spi_inst spi_inst_t;
+extern spi_inst_t *spi0, *spi1;
+
+#define SPI_SSPSR_TFE_BITS 0x01
+#define SPI_SSPSR_BSY_BITS 0x10
+#define SPI_SSPICR_RORIC_BITS 0x01
+
+// spi1 is wired to the panel model, spi0 (the SD card) goes nowhere
+extern uint spi_init(spi_inst_t *spi, uint baudrate);
+extern uint spi_set_baudrate(spi_inst_t *spi, uint baudrate);
+extern spi_hw_t *spi_get_hw(spi_inst_t *spi);
+extern bool spi_is_writable(spi_inst_t *spi);
+extern bool spi_is_readable(spi_inst_t *spi);
+extern int spi_write_blocking(spi_inst_t *spi, const uint8_t *src, size_t len);
+extern int spi_read_blocking(spi_inst_t *spi, uint8_t repeated_tx, uint8_t *dst, size_t len);
+extern int spi_write_read_blocking(spi_inst_t *spi, const uint8_t *src, uint8_t *dst, size_t len);
+
+#endif
@@ -0,0 +1,13 @@
+#ifndef HOST_HARDWARE_SYNC_H
+#define HOST_HARDWARE_SYNC_H
+
+#include "pico/platform.h"
+
+// simulated interrupts only run from sleep_ms(), so there is nothing to mask
+static inline uint32_t save_and_disable_interrupts(void) {
+    return 0;
+}
+
+static inline void restore_interrupts(uint32_t status) {}
+
+#endif
@@ -0,0 +1,10 @@
+#ifndef HOST_HARDWARE_TIMER_H
+#define HOST_HARDWARE_TIMER_H
+
+#include "pico/platform.h"
+
+// host wall clock, for timing; sleep_ms() does not move it
+extern uint64_t time_us_64(void);
+extern uint32_t time_us_32(void);
+
+#endif
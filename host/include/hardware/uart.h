@@ -0,0 +1,15 @@
+#ifndef HOST_HARDWARE_UART_H
+#define HOST_HARDWARE_UART_H
+
+#include "pico/platform.h"
+
+typedef struct uart_inst uart_inst_t;
+extern uart_inst_t *uart0, *uart1;
+
+#define UART_PARITY_NONE 0
+
+extern uint uart_init(uart_inst_t *uart, uint baudrate);
+extern void uart_set_format(uart_inst_t *uart, uint data_bits, uint stop_bits, int parity);
+extern void uart_set_fifo_enabled(uart_inst_t *uart, bool enabled);
+
+#endif
@@ -0,0 +1,9 @@
+#ifndef HOST_PICO_BOOTROM_H
+#define HOST_PICO_BOOTROM_H
+
+#include "pico/platform.h"
+
+// ends the simulation
+extern void reset_usb_boot(uint32_t gpio_mask, uint32_t disable_mask);
+
+#endif
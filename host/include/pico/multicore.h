@@ -0,0 +1,8 @@
+#ifndef HOST_PICO_MULTICORE_H
+#define HOST_PICO_MULTICORE_H
+
+#include "pico/platform.h"
+
+// lcd_render.c runs its server on a pthread on the host, nothing else uses core 1
+
+#endif
@@ -0,0 +1,28 @@
+#ifndef HOST_PICO_PLATFORM_H
+#define HOST_PICO_PLATFORM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Host stand-ins for the parts of the Pico SDK the firmware uses. Only what the
+// tree needs is declared; the behaviour lives in host/hal.c.
+
+#ifndef PICO_ON_DEVICE
+#define PICO_ON_DEVICE 0
+#endif
+
+typedef unsigned int uint;
+
+#define __not_in_flash_func(f) f
+#define __time_critical_func(f) f
+#define __isr
+#define count_of(a) (sizeof(a) / sizeof((a)[0]))
+
+static inline void tight_loop_contents(void) {}
+static inline void __sev(void) {}
+static inline void __wfe(void) {}
+
+extern uint get_core_num(void);
+
+#endif
@@ -0,0 +1,9 @@
+#ifndef HOST_PICO_STDIO_H
+#define HOST_PICO_STDIO_H
+
+#include "pico/platform.h"
+
+extern bool stdio_init_all(void);
+extern int getchar_timeout_us(uint32_t timeout_us);
+
+#endif
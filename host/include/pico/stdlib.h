@@ -0,0 +1,18 @@
+#ifndef HOST_PICO_STDLIB_H
+#define HOST_PICO_STDLIB_H
+
+#include "pico/platform.h"
+#include "pico/stdio.h"
+#include "hardware/gpio.h"
+#include "hardware/uart.h"
+#include "hardware/timer.h"
+
+#define PICO_ERROR_GENERIC -1
+#define PICO_ERROR_TIMEOUT -2
+
+// sleeping advances the simulated clock instead of waiting
+extern void sleep_ms(uint32_t ms);
+extern void sleep_us(uint64_t us);
+extern bool set_sys_clock_khz(uint32_t khz, bool required);
+
+#endif
@@ -0,0 +1,163 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "panel.h"
+#include "lcd_bmp.h"
+#include "lcd_scroll.h"
+
+#define CMD_CASET     0x2A
+#define CMD_PASET     0x2B
+#define CMD_RAMWR     0x2C
+#define CMD_RAMRD     0x2E
+#define CMD_VSCRDEF   0x33
+#define CMD_VSCRSADD  0x37
+#define CMD_COLMOD    0x3A
+
+static uint32_t gram[PANEL_ROWS][PANEL_W];
+static bool dc = false, selected = false;
+static uint8_t cmd = 0;
+static uint8_t param[8];
+static int nparam = 0;
+static int x1, x2, y1, y2;          // window
+static int px, py;                  // write/read pointer
+static bool packed = false;         // COLMOD 3 bit
+static uint8_t part[3];             // bytes of an 18 bit pixel still coming
+static int npart = 0;
+static bool read_dummy = false;     // RAMRD answers one dummy byte first
+static int tfa = 0, vsa = PANEL_ROWS, vsp = 0;
+
+void panel_reset(void) {
+    memset(gram, 0, sizeof(gram));
+    x1 = 0;
+    x2 = PANEL_W - 1;
+    y1 = 0;
+    y2 = PANEL_ROWS - 1;
+    packed = false;
+    tfa = 0;
+    vsa = PANEL_ROWS;
+    vsp = 0;
+}
+
+void panel_dc(bool level) {
+    dc = level;
+}
+
+void panel_cs(bool level) {
+    selected = !level;
+}
+
+static void put(uint32_t c) {
+    if (px >= 0 && px < PANEL_W && py >= 0 && py < PANEL_ROWS) gram[py][px] = c;
+    // past the end of the window the pointer starts over at its top left
+    if (++px > x2) {
+        px = x1;
+        if (++py > y2) py = y1;
+    }
+}
+
+static void command(uint8_t c) {
+    cmd = c;
+    nparam = 0;
+    npart = 0;
+    if (c == CMD_RAMWR || c == CMD_RAMRD) {
+        px = x1;
+        py = y1;
+        read_dummy = c == CMD_RAMRD;
+    }
+}
+
+static void parameter(uint8_t b) {
+    if (nparam < (int) sizeof(param)) param[nparam++] = b;
+    switch (cmd) {
+        case CMD_CASET:
+            if (nparam == 4) {
+                x1 = param[0] << 8 | param[1];
+                x2 = param[2] << 8 | param[3];
+            }
+            break;
+        case CMD_PASET:
+            if (nparam == 4) {
+                y1 = param[0] << 8 | param[1];
+                y2 = param[2] << 8 | param[3];
+            }
+            break;
+        case CMD_COLMOD:
+            packed = (b & 7) == 1;
+            break;
+        case CMD_VSCRDEF:
+            if (nparam == 6) {
+                tfa = param[0] << 8 | param[1];
+                vsa = param[2] << 8 | param[3];
+            }
+            break;
+        case CMD_VSCRSADD:
+            if (nparam == 2) vsp = param[0] << 8 | param[1];
+            break;
+        case CMD_RAMWR:
+            if (packed) {
+                // two pixels a byte, R G B in bits 5..3 then 2..0
+                for (int s = 3; s >= 0; s -= 3) {
+                    uint8_t v = b >> s;
+                    put((v & 4 ? 0xFF0000 : 0) | (v & 2 ? 0xFF00 : 0) | (v & 1 ? 0xFF : 0));
+                }
+            } else {
+                part[npart++] = b & 0xFC;
+                if (npart == 3) {
+                    put(part[0] << 16 | part[1] << 8 | part[2]);
+                    npart = 0;
+                }
+            }
+            break;
+    }
+}
+
+void panel_write(const uint8_t *src, size_t len) {
+    if (!selected) return;
+    for (size_t i = 0; i < len; i++) {
+        if (dc) parameter(src[i]);
+        else command(src[i]);
+    }
+}
+
+// RAMRD gives 18 bit pixels as R, G, B bytes after the dummy byte
+void panel_read(uint8_t *dst, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        if (!selected || cmd != CMD_RAMRD || read_dummy) {
+            read_dummy = false;
+            dst[i] = 0;
+            continue;
+        }
+        uint32_t c = (px < PANEL_W && py < PANEL_ROWS) ? gram[py][px] : 0;
+        dst[i] = c >> (16 - 8 * npart);
+        if (++npart == 3) {
+            npart = 0;
+            if (++px > x2) {
+                px = x1;
+                if (++py > y2) py = y1;
+            }
+        }
+    }
+}
+
+uint32_t panel_pixel(int x, int line) {
+    return gram[lcd_scroll_mock_shown_row(tfa, vsa, vsp, line)][x];
+}
+
+bool panel_write_bmp(const char *path) {
+    FILE *f = fopen(path, "wb");
+    if (!f) return false;
+    uint8_t hdr[LCD_BMP_HEADER], line[PANEL_W * 3];
+    lcd_bmp_header(hdr, PANEL_W, PANEL_H);
+    bool ok = fwrite(hdr, 1, sizeof(hdr), f) == sizeof(hdr);
+    for (int y = 0; ok && y < PANEL_H; y++) {
+        for (int x = 0; x < PANEL_W; x++) {
+            uint32_t c = panel_pixel(x, y);
+            line[x * 3] = c;
+            line[x * 3 + 1] = c >> 8;
+            line[x * 3 + 2] = c >> 16;
+        }
+        // through the writer lcd_screenshot() uses, so the two files compare equal
+        ok = lcd_bmp_write_rows(f, line, PANEL_W, 1);
+    }
+    return fclose(f) == 0 && ok;
+}
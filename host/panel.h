@@ -0,0 +1,26 @@
+#ifndef HOST_PANEL_H
+#define HOST_PANEL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Model of the ILI9488 behind SPI1: decodes the byte stream by the DC and CS lines
+// into 480 rows of GRAM, following CASET/PASET windows, COLMOD (18 or 3 bit),
+// RAMWR/RAMRD and vertical scrolling, the parts of the controller the driver uses.
+
+#define PANEL_W     320
+#define PANEL_H     320     // visible lines
+#define PANEL_ROWS  480     // GRAM rows
+
+extern void panel_reset(void);
+extern void panel_dc(bool level);
+extern void panel_cs(bool level);
+extern void panel_write(const uint8_t *src, size_t len);
+extern void panel_read(uint8_t *dst, size_t len);
+
+// RGB() colour shown on visible line `line`, with the scroll registers applied
+extern uint32_t panel_pixel(int x, int line);
+extern bool panel_write_bmp(const char *path);
+
+#endif
@@ -0,0 +1,230 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "pico/stdlib.h"
+
+#include "lcdspi.h"
+#include "lcd_render.h"
+#include "keyboard_definition.h"
+#include "panel.h"
+#include "sim.h"
+
+// Host simulator: runs the firmware's main() against the shims in this directory.
+// Keys come from a script, one command a line:
+//   type <text>        the characters of text
+//   key <name> [n]     a named key (F1, ENTER, UP, ...) or a single character, n times
+//   shot <file.bmp>    the visible screen as it is after the previous key
+//   # ...              comment
+// Every key is reported with the host time it took, including rendering, and the
+// bus traffic it caused. The run ends when the script does.
+
+#define MAX_STEPS 4096
+
+typedef struct {
+    int key;                // 0 for a shot
+    char *shot;
+} step_t;
+
+static const struct {
+    const char *name;
+    int key;
+} key_names[] = {
+    {"F1", KEY_F1}, {"F2", KEY_F2}, {"F3", KEY_F3}, {"F4", KEY_F4}, {"F5", KEY_F5}, {"F6", KEY_F6},
+    {"ENTER", KEY_ENTER}, {"BACKSPACE", KEY_BACKSPACE}, {"TAB", KEY_TAB}, {"ESC", KEY_ESC},
+    {"UP", KEY_UP}, {"DOWN", KEY_DOWN}, {"LEFT", KEY_LEFT}, {"RIGHT", KEY_RIGHT},
+    {"HOME", KEY_HOME}, {"DEL", KEY_DEL}, {"INSERT", KEY_INSERT}, {"BREAK", KEY_BREAK},
+    {"PGUP", KEY_PAGE_UP}, {"PGDN", KEY_PAGE_DOWN},
+    {"SPACE", ' '},
+};
+
+static step_t steps[MAX_STEPS];
+static int nsteps = 0, next = 0;
+static const char *final_bmp = NULL;
+static bool quiet = false;
+
+static int last_key = -1;           // -1: start-up
+static bool step_open = false;
+static uint64_t t_start;
+static lcd_stats_t stats_start;
+static uint64_t total_us = 0;
+static uint32_t total_bytes = 0, total_windows = 0, nkeys = 0;
+
+extern int coyote_main(void);
+
+static void add_step(int key, const char *shot) {
+    if (nsteps == MAX_STEPS) {
+        fprintf(stderr, "coyote_host: more than %d steps in the script\n", MAX_STEPS);
+        exit(2);
+    }
+    steps[nsteps].key = key;
+    steps[nsteps].shot = shot ? strdup(shot) : NULL;
+    nsteps++;
+}
+
+static int key_code(const char *name) {
+    for (size_t i = 0; i < count_of(key_names); i++) {
+        if (!strcasecmp(name, key_names[i].name)) return key_names[i].key;
+    }
+    if (strlen(name) == 1) return (unsigned char) name[0];
+    return -1;
+}
+
+static bool load_script(const char *path) {
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        perror(path);
+        return false;
+    }
+    char line[512];
+    int ln = 0;
+    while (fgets(line, sizeof(line), f)) {
+        ln++;
+        line[strcspn(line, "\r\n")] = 0;
+        char *p = line;
+        while (isspace((unsigned char) *p)) p++;
+        if (!*p || *p == '#') continue;
+        char *arg = p + strcspn(p, " \t");
+        if (*arg) *arg++ = 0;
+        if (!strcmp(p, "type")) {
+            for (; *arg; arg++) add_step((unsigned char) *arg, NULL);
+        } else if (!strcmp(p, "key")) {
+            char name[32];
+            int n = 1;
+            if (sscanf(arg, "%31s %d", name, &n) < 1 || key_code(name) < 0) {
+                fprintf(stderr, "%s:%d: unknown key '%s'\n", path, ln, arg);
+                return false;
+            }
+            while (n-- > 0) add_step(key_code(name), NULL);
+        } else if (!strcmp(p, "shot") && *arg) {
+            add_step(0, arg);
+        } else {
+            fprintf(stderr, "%s:%d: cannot parse '%s'\n", path, ln, p);
+            return false;
+        }
+    }
+    fclose(f);
+    return true;
+}
+
+static const char *key_label(int key, char *buf) {
+    if (key < 0) return "start-up";
+    for (size_t i = 0; i < count_of(key_names); i++) {
+        if (key_names[i].key == key) return key_names[i].name;
+    }
+    snprintf(buf, 16, isprint(key) ? "'%c'" : "0x%02x", key);
+    return buf;
+}
+
+// closes the measurement of the key handled since the last poll
+static void end_step(void) {
+    step_open = false;
+    lcd_render_sync();
+    uint64_t us = time_us_64() - t_start;
+    uint32_t bytes = lcd_stats.bytes - stats_start.bytes;
+    uint32_t windows = lcd_stats.windows - stats_start.windows;
+    uint32_t edges, sound_us;
+    hal_sound_take(&edges, &sound_us);
+    if (last_key >= 0) {
+        total_us += us;
+        total_bytes += bytes;
+        total_windows += windows;
+        nkeys++;
+    }
+    if (!quiet) {
+        char buf[16];
+        printf("%-10s %9.3f ms host %8lu bytes %5lu windows %8.2f ms bus", key_label(last_key, buf),
+               us / 1000.0, (unsigned long) bytes, (unsigned long) windows,
+               bytes * 8000.0 / LCD_SPI_SPEED);
+        if (edges && sound_us) printf("  sound %lu Hz", (unsigned long) (edges * 500000ull / sound_us));
+        printf("\n");
+    }
+}
+
+static void start_step(int key) {
+    last_key = key;
+    step_open = true;
+    stats_start = lcd_stats;
+    t_start = time_us_64();
+}
+
+uint16_t sim_poll_key(void) {
+    end_step();
+    while (next < nsteps && !steps[next].key) {
+        if (!panel_write_bmp(steps[next].shot)) fprintf(stderr, "coyote_host: cannot write %s\n", steps[next].shot);
+        next++;
+    }
+    if (next == nsteps) sim_finish("end of script");
+    int key = steps[next++].key;
+    start_step(key);
+    return key << 8 | 1;
+}
+
+void sim_finish(const char *why) {
+    if (step_open) end_step();
+    if (final_bmp && !panel_write_bmp(final_bmp)) fprintf(stderr, "coyote_host: cannot write %s\n", final_bmp);
+    printf("%s: %lu keys, %.3f ms host, %lu bytes, %lu windows, %.2f ms bus\n", why,
+           (unsigned long) nkeys, total_us / 1000.0, (unsigned long) total_bytes,
+           (unsigned long) total_windows, total_bytes * 8000.0 / LCD_SPI_SPEED);
+    fflush(stdout);
+    exit(0);
+}
+
+static void usage(void) {
+    fprintf(stderr, "usage: coyote_host [-k keys.txt] [-d dir] [-o screen.bmp] [-q]\n"
+                    "  -k  key script (without one the run ends after start-up)\n"
+                    "  -d  directory that stands in for the SD card (default sdcard)\n"
+                    "  -o  write the final screen as a BMP\n"
+                    "  -q  only print the totals\n");
+    exit(2);
+}
+
+int main(int argc, char **argv) {
+    const char *script = NULL, *dir = "sdcard";
+    int opt;
+    while ((opt = getopt(argc, argv, "k:d:o:q")) != -1) {
+        switch (opt) {
+            case 'k':
+                script = optarg;
+                break;
+            case 'd':
+                dir = optarg;
+                break;
+            case 'o':
+                final_bmp = optarg;
+                break;
+            case 'q':
+                quiet = true;
+                break;
+            default:
+                usage();
+        }
+    }
+    if (script && !load_script(script)) return 2;
+    // BMP paths are taken relative to where we were started
+    char cwd[1024];
+    if (!getcwd(cwd, sizeof(cwd))) return 2;
+    static char bmp_path[1200];
+    if (final_bmp && final_bmp[0] != '/') {
+        snprintf(bmp_path, sizeof(bmp_path), "%s/%s", cwd, final_bmp);
+        final_bmp = bmp_path;
+    }
+    for (int i = 0; i < nsteps; i++) {
+        if (steps[i].shot && steps[i].shot[0] != '/') {
+            char *p = malloc(strlen(cwd) + strlen(steps[i].shot) + 2);
+            sprintf(p, "%s/%s", cwd, steps[i].shot);
+            free(steps[i].shot);
+            steps[i].shot = p;
+        }
+    }
+    mkdir(dir, 0755);
+    if (chdir(dir)) {
+        perror(dir);
+        return 2;
+    }
+    start_step(-1);
+    return coyote_main();
+}
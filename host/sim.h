@@ -0,0 +1,15 @@
+#ifndef HOST_SIM_H
+#define HOST_SIM_H
+
+#include <stdint.h>
+
+// Keyboard controller FIFO entry for the next poll: key << 8 | state, 0 when idle.
+// Each poll first closes the measurement of the key before it.
+extern uint16_t sim_poll_key(void);
+// ends the run: final report and frame, then exit
+extern void sim_finish(const char *why);
+
+// simulated sound since the last call: PWM level edges and the time they span
+extern void hal_sound_take(uint32_t *edges, uint32_t *us);
+
+#endif
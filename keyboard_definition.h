@@ -22,6 +22,8 @@
 #define KEY_INSERT    0xD1
 #define KEY_HOME      0xD2
 #define KEY_DEL       0xD4
+#define KEY_PAGE_UP   0xD6 // Shift+Up
+#define KEY_PAGE_DOWN 0xD7 // Shift+Down
 
 
 #define KEY_CAPS_LOCK   0xC1
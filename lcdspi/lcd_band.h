@@ -0,0 +1,26 @@
+#ifndef LCD_BAND_H
+#define LCD_BAND_H
+
+// Band compositor. Between lcd_band_begin() and lcd_band_end() the render core keeps
+// rectangles, pixels, lines, text and bitmaps in a display list instead of drawing
+// them. At the end the area they touch is rasterised LCD_BAND_ROWS rows at a time
+// into one of two SRAM band buffers, every command clipped to the band, and each band
+// goes out as one write window while the next one is composited. Overdraw, such as
+// clearing to white and then drawing text, then costs CPU time instead of bus time,
+// and a screen of many small pieces becomes a few large windows.
+//
+// Pixels no recorded command covers keep what the PSRAM shadow says the panel shows,
+// unless a rectangle covering the whole band makes that unnecessary. Any other
+// command (blit, readback, scroll, ...) sends what was recorded before it runs, and
+// so does a full list. A list whose bands would go out in 18 bit while its own pieces
+// would mostly be 3 bit (thin coloured lines over a fill) is drawn directly instead.
+// Without the shadow everything is drawn directly.
+// See host/bench.c for a comparison with direct drawing.
+
+#define LCD_BAND_ROWS       16
+#define LCD_BAND_LIST_MAX   64
+
+extern void lcd_band_begin(void);
+extern void lcd_band_end(void);
+
+#endif
@@ -0,0 +1,38 @@
+#include <string.h>
+
+#include "lcd_bmp.h"
+
+static void put_le(uint8_t *p, uint32_t v, int n) {
+    for (int i = 0; i < n; i++) p[i] = v >> (8 * i);
+}
+
+void lcd_bmp_header(uint8_t hdr[LCD_BMP_HEADER], int w, int h) {
+    uint32_t data_len = lcd_bmp_stride(w) * h;
+    memset(hdr, 0, LCD_BMP_HEADER);
+    hdr[0] = 'B';
+    hdr[1] = 'M';
+    put_le(hdr + 2, LCD_BMP_HEADER + data_len, 4);
+    put_le(hdr + 10, LCD_BMP_HEADER, 4);
+    put_le(hdr + 14, 40, 4);                // BITMAPINFOHEADER
+    put_le(hdr + 18, w, 4);
+    put_le(hdr + 22, (uint32_t) -h, 4);     // negative height: top-down rows
+    put_le(hdr + 26, 1, 2);
+    put_le(hdr + 28, 24, 2);
+    put_le(hdr + 34, data_len, 4);
+    put_le(hdr + 38, 2835, 4);              // 72 dpi
+    put_le(hdr + 42, 2835, 4);
+}
+
+void lcd_bmp_expand(uint8_t *px, int bytes) {
+    for (uint8_t *end = px + bytes; px < end; px++) *px = (*px & 0xFC) | (*px >> 6);
+}
+
+bool lcd_bmp_write_rows(FILE *f, uint8_t *px, int w, int n) {
+    static const uint8_t pad[3];
+    size_t row = (size_t) w * 3, extra = lcd_bmp_stride(w) - row;
+    lcd_bmp_expand(px, (int) row * n);
+    if (!extra) return fwrite(px, 1, row * n, f) == row * n;
+    for (int i = 0; i < n; i++, px += row)
+        if (fwrite(px, 1, row, f) != row || fwrite(pad, 1, extra, f) != extra) return false;
+    return true;
+}
@@ -0,0 +1,27 @@
+#ifndef LCD_BMP_H
+#define LCD_BMP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// 24 bit BMP pieces for writing a picture out a band of rows at a time. The header
+// declares the rows top-down, so they go out in screen order and pixels are the
+// [B,G,R] triples read_buffer_spi() gives. Plain C, no SDK.
+
+#define LCD_BMP_HEADER  54
+
+// bytes of one row in the file, padded to four
+static inline int lcd_bmp_stride(int w) {
+    return (w * 3 + 3) & ~3;
+}
+
+extern void lcd_bmp_header(uint8_t hdr[LCD_BMP_HEADER], int w, int h);
+// the panel keeps 6 bits a channel; copies them into the low bits as well so
+// white reads back as 0xFF rather than 0xFC
+extern void lcd_bmp_expand(uint8_t *px, int bytes);
+// expands n rows of w pixels at px in place and appends them to f, padded to the
+// stride; false on a write error
+extern bool lcd_bmp_write_rows(FILE *f, uint8_t *px, int w, int n);
+
+#endif
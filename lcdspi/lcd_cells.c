@@ -0,0 +1,116 @@
+#include <string.h>
+
+#include "pico/stdlib.h"
+
+#include "lcdspi.h"
+#include "lcd_cells.h"
+
+#define CELL_UNKNOWN 0      // never printed, so it matches no grid cell
+
+static uint32_t colours[LCD_CELL_COLOURS];
+static int colours_used = 0;
+static lcd_cells_t panel;   // what the panel shows
+static bool panel_valid = false;
+
+// colour table slot, allocated on first use; once full, unknown colours get slot 0
+static uint8_t colour_index(uint32_t c) {
+    for (int i = 0; i < colours_used; i++) {
+        if (colours[i] == c) return i;
+    }
+    if (colours_used == LCD_CELL_COLOURS) return 0;
+    colours[colours_used] = c;
+    return colours_used++;
+}
+
+void lcd_cells_set_colour(lcd_cells_t *g, uint32_t fc, uint32_t bc) {
+    g->cur_attr = (colour_index(fc) << 4) | colour_index(bc);
+}
+
+void lcd_cells_clear(lcd_cells_t *g, uint32_t fc, uint32_t bc) {
+    lcd_cells_set_colour(g, fc, bc);
+    memset(g->ch, ' ', sizeof(g->ch));
+    memset(g->attr, g->cur_attr, sizeof(g->attr));
+    g->col = g->row = 0;
+}
+
+static void new_line(lcd_cells_t *g) {
+    g->col = 0;
+    if (++g->row < LCD_CELL_ROWS) return;
+    g->row = LCD_CELL_ROWS - 1;
+    memmove(g->ch[0], g->ch[1], sizeof(g->ch[0]) * (LCD_CELL_ROWS - 1));
+    memmove(g->attr[0], g->attr[1], sizeof(g->attr[0]) * (LCD_CELL_ROWS - 1));
+    memset(g->ch[g->row], ' ', LCD_CELL_COLS);
+    memset(g->attr[g->row], g->cur_attr, LCD_CELL_COLS);
+}
+
+void lcd_cells_print(lcd_cells_t *g, const char *s) {
+    for (; *s; s++) {
+        if (*s == '\n') {
+            new_line(g);
+        } else if (*s == '\r') {
+            g->col = 0;
+        } else if ((unsigned char) *s >= ' ') {
+            if (g->col == LCD_CELL_COLS) new_line(g);
+            g->ch[g->row][g->col] = *s;
+            g->attr[g->row][g->col] = g->cur_attr;
+            g->col++;
+        }
+    }
+}
+
+// a space only shows its background, so the foreground colour may differ
+static inline bool same_cell(const lcd_cells_t *g, int r, int c) {
+    if (panel.ch[r][c] != g->ch[r][c]) return false;
+    if (panel.attr[r][c] == g->attr[r][c]) return true;
+    return g->ch[r][c] == ' ' && ((panel.attr[r][c] ^ g->attr[r][c]) & 0x0F) == 0;
+}
+
+void lcd_cells_present(const lcd_cells_t *g) {
+    for (int r = 0; r < LCD_CELL_ROWS; r++) {
+        int c = 0;
+        while (c < LCD_CELL_COLS) {
+            if (same_cell(g, r, c)) {
+                c++;
+                continue;
+            }
+            // each stretch of changed cells in one colour pair is one text run
+            int start = c;
+            uint8_t a = g->attr[r][c];
+            while (c < LCD_CELL_COLS && !same_cell(g, r, c) && g->attr[r][c] == a) c++;
+            lcd_print_run(colours[a >> 4], colours[a & 0x0F], &g->ch[r][start], c - start,
+                          start * LCD_CELL_W, r * LCD_CELL_H);
+            memcpy(&panel.ch[r][start], &g->ch[r][start], c - start);
+            memset(&panel.attr[r][start], a, c - start);
+        }
+    }
+}
+
+void lcd_cells_blank(uint32_t bc) {
+    lcd_cells_clear(&panel, bc, bc);
+    panel_valid = true;
+}
+
+void lcd_cells_assume(const lcd_cells_t *g) {
+    panel = *g;
+    panel_valid = true;
+}
+
+void lcd_cells_invalidate(void) {
+    panel_valid = false;
+    memset(panel.ch, CELL_UNKNOWN, sizeof(panel.ch));
+}
+
+void lcd_cells_invalidate_area(int x1, int y1, int x2, int y2) {
+    int c1 = x1 / LCD_CELL_W, c2 = x2 / LCD_CELL_W, r1 = y1 / LCD_CELL_H, r2 = y2 / LCD_CELL_H;
+    if (c1 < 0) c1 = 0;
+    if (r1 < 0) r1 = 0;
+    if (c2 >= LCD_CELL_COLS) c2 = LCD_CELL_COLS - 1;
+    if (r2 >= LCD_CELL_ROWS) r2 = LCD_CELL_ROWS - 1;
+    for (int r = r1; r <= r2; r++) {
+        for (int c = c1; c <= c2; c++) panel.ch[r][c] = CELL_UNKNOWN;
+    }
+}
+
+bool lcd_cells_valid(void) {
+    return panel_valid;
+}
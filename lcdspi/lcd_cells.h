@@ -0,0 +1,42 @@
+#ifndef LCD_CELLS_H
+#define LCD_CELLS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Character-cell model of a text screen: LCD_CELL_COLS x LCD_CELL_ROWS cells of the
+// 8x12 main font, each a character and a colour pair. Screens are built in a grid
+// off-line; lcd_cells_present() compares it with what the panel shows and redraws
+// only the cells that differ.
+
+#define LCD_CELL_W          8
+#define LCD_CELL_H          12
+#define LCD_CELL_COLS       40
+#define LCD_CELL_ROWS       24
+#define LCD_CELL_COLOURS    16
+
+typedef struct {
+    char ch[LCD_CELL_ROWS][LCD_CELL_COLS];
+    uint8_t attr[LCD_CELL_ROWS][LCD_CELL_COLS];     // foreground index << 4 | background index
+    uint8_t cur_attr;
+    int col, row;           // where lcd_cells_print() goes on
+} lcd_cells_t;
+
+extern void lcd_cells_clear(lcd_cells_t *g, uint32_t fc, uint32_t bc);
+extern void lcd_cells_set_colour(lcd_cells_t *g, uint32_t fc, uint32_t bc);
+// console style output: wraps at the right edge, handles \r and \n, scrolls the grid
+extern void lcd_cells_print(lcd_cells_t *g, const char *s);
+
+extern void lcd_cells_present(const lcd_cells_t *g);
+
+// the panel's cell area has just been filled with bc
+extern void lcd_cells_blank(uint32_t bc);
+// the panel's cell area now shows g, e.g. from a picture taken of it earlier
+extern void lcd_cells_assume(const lcd_cells_t *g);
+// something else drew over the cell area, all of it or the pixels x1..y2
+extern void lcd_cells_invalidate(void);
+extern void lcd_cells_invalidate_area(int x1, int y1, int x2, int y2);
+// false until lcd_cells_blank() once the panel contents are unknown
+extern bool lcd_cells_valid(void);
+
+#endif
@@ -0,0 +1,136 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "lcdspi.h"
+#include "lcd_scroll.h"
+#include "lcd_console.h"
+
+static struct {
+    int x, y;               // cursor
+    uint32_t fc, bc;
+    int start, len;         // buf[0 .. len) is still to be drawn, from x = start
+    char buf[LCD_CONSOLE_BUF];
+} con = {.fc = GREEN, .bc = BLACK};
+
+void lcd_console_goto(int x, int y) {
+    con.x = x;
+    con.y = y;
+}
+
+void lcd_console_where(int *x, int *y) {
+    *x = con.x;
+    *y = con.y;
+}
+
+void lcd_console_set_colour(uint32_t fc, uint32_t bc) {
+    con.fc = fc;
+    con.bc = bc;
+}
+
+uint32_t lcd_console_fcolour(void) {
+    return con.fc;
+}
+
+uint32_t lcd_console_bcolour(void) {
+    return con.bc;
+}
+
+// draws the pending part of the line
+static void emit(void) {
+    if (con.len) lcd_print_run(con.fc, con.bc, con.buf, con.len, con.start, con.y);
+    con.len = 0;
+}
+
+static void newline(void) {
+    int h = lcd_font_main.height, rows = lcd_scroll_rows();
+    emit();
+    con.x = 0;
+    con.y += h;
+    if (con.y + h >= rows) {
+        scroll_lcd_spi(con.y + h - rows);
+        con.y -= con.y + h - rows;
+    }
+}
+
+// adds a character to the line, wrapping first when it does not fit
+static void put(char c) {
+    int w = lcd_font_main.width;
+    if (con.x + w > LCD_WIDTH) newline();
+    if (!con.len) con.start = con.x;
+    con.buf[con.len++] = c;
+    con.x += w;
+}
+
+// buf[len .. len + n) has just arrived. It is taken apart in place: characters
+// only ever move towards the front, so nothing is overwritten before it is read.
+static void layout(int n) {
+    int w = lcd_font_main.width;
+    const char *p = con.buf + con.len, *end = p + n;
+    for (; p < end; p++) {
+        switch (*p) {
+            case '\b':
+                emit();
+                con.x -= w;
+                if (con.x < 0) {
+                    // end of the line above
+                    con.y -= lcd_font_main.height;
+                    if (con.y < 0) con.y = 0;
+                    con.x = (LCD_WIDTH / w - 1) * w;
+                }
+                break;
+            case '\r':
+                emit();
+                con.x = 0;
+                break;
+            case '\n':
+                newline();
+                break;
+            case '\t': {
+                // spaces to the next even column, drawn on their own as they would
+                // not fit in front of the characters still to be read
+                emit();
+                if (con.x + w > LCD_WIDTH) newline();
+                int n = (con.x / w) % 2 ? 1 : 2;
+                lcd_print_run(con.fc, con.bc, "  ", n, con.x, con.y);
+                con.x += n * w;
+                break;
+            }
+            default:
+                put(*p);
+        }
+    }
+}
+
+void lcd_console_write(const char *s, int len) {
+    while (len > 0) {
+        int n = LCD_CONSOLE_BUF - con.len;
+        if (n > len) n = len;
+        memcpy(con.buf + con.len, s, n);
+        layout(n);
+        s += n;
+        len -= n;
+    }
+    emit();
+}
+
+void lcd_console_puts(const char *s) {
+    lcd_console_write(s, strlen(s));
+}
+
+void lcd_console_putc(char c) {
+    lcd_console_write(&c, 1);
+}
+
+void lcd_console_vprintf(const char *fmt, va_list ap) {
+    int n = vsnprintf(con.buf, sizeof(con.buf), fmt, ap);
+    if (n >= (int) sizeof(con.buf)) n = sizeof(con.buf) - 1;
+    if (n > 0) layout(n);
+    emit();
+}
+
+void lcd_console_printf(const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    lcd_console_vprintf(fmt, ap);
+    va_end(ap);
+}
@@ -0,0 +1,30 @@
+#ifndef LCD_CONSOLE_H
+#define LCD_CONSOLE_H
+
+#include <stdint.h>
+#include <stdarg.h>
+
+// Text console in the main font: cursor, colours and a line buffer of its own.
+// Output is laid out in one pass, printable characters collect in the line buffer
+// and go to the renderer as one run when the line wraps or a control character
+// moves the cursor. Whatever is left is drawn before the call returns, so drawing
+// queued afterwards never overtakes it. The cursor row is a logical row of the
+// scroll area (see lcd_scroll.h); a newline at its bottom scrolls it.
+
+#define LCD_CONSOLE_BUF     256     // longest lcd_console_printf() output, the rest is cut off
+
+extern void lcd_console_goto(int x, int y);
+extern void lcd_console_where(int *x, int *y);
+extern void lcd_console_set_colour(uint32_t fc, uint32_t bc);
+extern uint32_t lcd_console_fcolour(void);
+extern uint32_t lcd_console_bcolour(void);
+
+// understands \b, \r, \n and \t
+extern void lcd_console_write(const char *s, int len);
+extern void lcd_console_puts(const char *s);
+extern void lcd_console_putc(char c);
+// formats straight into the line buffer
+extern void lcd_console_printf(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+extern void lcd_console_vprintf(const char *fmt, va_list ap);
+
+#endif
@@ -0,0 +1,276 @@
+#include <string.h>
+
+#include "pico/stdlib.h"
+#include <hardware/spi.h>
+#if PICO_ON_DEVICE
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+#endif
+
+#include "lcdspi.h"
+#include "lcd_dma.h"
+#include "lcd_trace.h"
+
+#define LCD_DMA_IRQ DMA_IRQ_1
+
+typedef struct {
+    const uint8_t *src;
+    uint32_t len;       // total bytes to send
+    uint16_t block;     // >0: src is a block of this size repeated until len is reached
+    uint16_t flags;
+    lcd_fence_t fence;
+    lcd_dma_callback_t cb;
+    void *arg;
+} lcd_dma_job_t;
+
+static lcd_dma_job_t queue[LCD_DMA_QUEUE_LEN];
+static volatile uint32_t q_head = 0, q_tail = 0;
+static volatile bool running = false;
+static uint32_t cur_left;                   // bytes of the head job still to be started
+static lcd_fence_t fence_issued = 0;
+static volatile lcd_fence_t fence_done = 0;
+
+// two fill patterns so a new colour can be prepared while the last fill is still going out
+static uint8_t fill_pattern[2][LCD_DMA_FILL_PIXELS * 3];
+static uint32_t fill_colour[2] = {0xFFFFFFFF, 0xFFFFFFFF};
+static lcd_fence_t fill_fence[2];
+static int fill_next = 0;
+
+// CS of an LCD_DMA_END job whose last bytes were still shifting out when its DMA
+// finished: the interrupt does not wait for the SPI, lcd_dma_wait_idle() raises it
+static volatile bool cs_pending = false;
+
+static inline uint32_t next_block(const lcd_dma_job_t *j) {
+    uint32_t n = cur_left;
+    if (j->block && n > j->block) n = j->block;
+    cur_left -= n;
+    return n;
+}
+
+// TX FIFO empty and the last frame shifted out
+static inline bool spi_drained(void) {
+    uint32_t sr = spi_get_hw(Pico_LCD_SPI_MOD)->sr;
+    return (sr & SPI_SSPSR_TFE_BITS) && !(sr & SPI_SSPSR_BSY_BITS);
+}
+
+static void job_finished(void) {
+    lcd_dma_job_t *j = &queue[q_head % LCD_DMA_QUEUE_LEN];
+    if (j->flags & LCD_DMA_END) {
+        if (spi_drained()) lcd_spi_raise_cs();
+        else cs_pending = true;
+    }
+    fence_done = j->fence;
+    if (j->cb) j->cb(j->fence, j->arg);
+    q_head++;
+}
+
+#if PICO_ON_DEVICE
+
+static int dma_chan = -1;
+static dma_channel_config dma_cfg;
+
+static void __not_in_flash_func(start_block)(void) {
+    const lcd_dma_job_t *j = &queue[q_head % LCD_DMA_QUEUE_LEN];
+    const uint8_t *src = j->block ? j->src : j->src + (j->len - cur_left);
+    dma_channel_transfer_from_buffer_now(dma_chan, src, next_block(j));
+}
+
+static void __not_in_flash_func(start_next_job)(void) {
+    if (q_head == q_tail) {
+        running = false;
+        return;
+    }
+    running = true;
+    cur_left = queue[q_head % LCD_DMA_QUEUE_LEN].len;
+    start_block();
+}
+
+static void __isr __not_in_flash_func(lcd_dma_irq_handler)(void) {
+    if (!(dma_hw->ints1 & (1u << dma_chan))) return;
+    dma_hw->ints1 = 1u << dma_chan;
+    if (cur_left) {
+        start_block();
+        return;
+    }
+    job_finished();
+    start_next_job();
+}
+
+void lcd_dma_init(void) {
+    if (dma_chan >= 0) return;
+    dma_chan = dma_claim_unused_channel(true);
+    dma_cfg = dma_channel_get_default_config(dma_chan);
+    channel_config_set_transfer_data_size(&dma_cfg, DMA_SIZE_8);
+    channel_config_set_read_increment(&dma_cfg, true);
+    channel_config_set_write_increment(&dma_cfg, false);
+    channel_config_set_dreq(&dma_cfg, spi_get_dreq(Pico_LCD_SPI_MOD, true));
+    dma_channel_configure(dma_chan, &dma_cfg, &spi_get_hw(Pico_LCD_SPI_MOD)->dr, NULL, 0, false);
+
+    irq_add_shared_handler(LCD_DMA_IRQ, lcd_dma_irq_handler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    dma_channel_set_irq1_enabled(dma_chan, true);
+    irq_set_enabled(LCD_DMA_IRQ, true);
+}
+
+static lcd_fence_t lcd_dma_push(const uint8_t *src, uint32_t len, uint16_t block, uint16_t flags,
+                                lcd_dma_callback_t cb, void *arg) {
+    while (q_tail - q_head >= LCD_DMA_QUEUE_LEN)
+        tight_loop_contents();
+
+    lcd_dma_job_t *j = &queue[q_tail % LCD_DMA_QUEUE_LEN];
+    j->src = src;
+    j->len = len;
+    j->block = block;
+    j->flags = flags;
+    j->fence = ++fence_issued;
+    j->cb = cb;
+    j->arg = arg;
+    lcd_stats.bytes += len;
+    lcd_trace_dma(src, len, block != 0);
+
+    uint32_t irq = save_and_disable_interrupts();
+    q_tail++;
+    if (!running) start_next_job();
+    restore_interrupts(irq);
+    return j->fence;
+}
+
+bool lcd_dma_busy(void) {
+    return running;
+}
+
+#else
+
+static lcd_dma_sink_t mock_sink = NULL;
+
+void lcd_dma_init(void) {
+}
+
+void lcd_dma_mock_set_sink(lcd_dma_sink_t sink) {
+    mock_sink = sink;
+}
+
+int lcd_dma_mock_pending(void) {
+    return (int) (q_tail - q_head);
+}
+
+// moves one DMA block of the head job into the sink, returns false once idle
+bool lcd_dma_mock_step(void) {
+    if (q_head == q_tail) {
+        running = false;
+        return false;
+    }
+    const lcd_dma_job_t *j = &queue[q_head % LCD_DMA_QUEUE_LEN];
+    if (!running) {
+        running = true;
+        cur_left = j->len;
+    }
+    const uint8_t *src = j->block ? j->src : j->src + (j->len - cur_left);
+    uint32_t n = next_block(j);
+    if (mock_sink) mock_sink(src, n);
+    else spi_write_blocking(Pico_LCD_SPI_MOD, src, n);
+    if (!cur_left) {
+        job_finished();
+        running = false;
+    }
+    return true;
+}
+
+static lcd_fence_t lcd_dma_push(const uint8_t *src, uint32_t len, uint16_t block, uint16_t flags,
+                                lcd_dma_callback_t cb, void *arg) {
+    while (q_tail - q_head >= LCD_DMA_QUEUE_LEN)
+        lcd_dma_mock_step();
+
+    lcd_dma_job_t *j = &queue[q_tail % LCD_DMA_QUEUE_LEN];
+    j->src = src;
+    j->len = len;
+    j->block = block;
+    j->flags = flags;
+    j->fence = ++fence_issued;
+    j->cb = cb;
+    j->arg = arg;
+    lcd_stats.bytes += len;
+    lcd_trace_dma(src, len, block != 0);
+    q_tail++;
+    return j->fence;
+}
+
+bool lcd_dma_busy(void) {
+    return q_head != q_tail;
+}
+
+#endif
+
+bool lcd_dma_done(lcd_fence_t fence) {
+    return (int32_t) (fence_done - fence) >= 0;
+}
+
+lcd_fence_t lcd_dma_last_fence(void) {
+    return fence_issued;
+}
+
+void lcd_dma_wait(lcd_fence_t fence) {
+    while (!lcd_dma_done(fence)) {
+#if PICO_ON_DEVICE
+        tight_loop_contents();
+#else
+        lcd_dma_mock_step();
+#endif
+    }
+}
+
+void lcd_dma_wait_idle(void) {
+    lcd_dma_wait(fence_issued);
+    // the last job's DMA is done but its bytes may still be in the FIFO
+    spi_finish(Pico_LCD_SPI_MOD);
+    if (cs_pending) {
+        cs_pending = false;
+        lcd_spi_raise_cs();
+    }
+}
+
+lcd_fence_t lcd_dma_send_cb(const uint8_t *src, uint32_t len, uint16_t flags,
+                            lcd_dma_callback_t cb, void *arg) {
+    if (!len) {
+        // nothing to move, but the caller still expects the transaction to be closed
+        lcd_dma_wait_idle();
+        if (flags & LCD_DMA_END) lcd_spi_raise_cs();
+        if (cb) cb(fence_issued, arg);
+        return fence_issued;
+    }
+    return lcd_dma_push(src, len, 0, flags, cb, arg);
+}
+
+lcd_fence_t lcd_dma_send(const uint8_t *src, uint32_t len, uint16_t flags) {
+    return lcd_dma_send_cb(src, len, flags, NULL, NULL);
+}
+
+static lcd_fence_t fill_push(uint32_t colour, uint32_t len, uint16_t flags) {
+    int b;
+    if (fill_colour[0] == colour) b = 0;
+    else if (fill_colour[1] == colour) b = 1;
+    else {
+        // reuse the older pattern once nothing in flight still reads it
+        b = fill_next;
+        fill_next ^= 1;
+        lcd_dma_wait(fill_fence[b]);
+        uint8_t *p = fill_pattern[b];
+        for (int i = 0; i < LCD_DMA_FILL_PIXELS; i++) {
+            *p++ = colour >> 16;
+            *p++ = (colour >> 8) & 0xFF;
+            *p++ = colour & 0xFF;
+        }
+        fill_colour[b] = colour;
+    }
+    if (!len) return lcd_dma_send(NULL, 0, flags);
+    fill_fence[b] = lcd_dma_push(fill_pattern[b], len, sizeof(fill_pattern[b]), flags, NULL, NULL);
+    return fill_fence[b];
+}
+
+lcd_fence_t lcd_dma_fill(uint32_t colour, uint32_t pixels, uint16_t flags) {
+    return fill_push(colour & 0xFFFFFF, pixels * 3, flags);
+}
+
+lcd_fence_t lcd_dma_fill_bytes(uint8_t value, uint32_t len, uint16_t flags) {
+    return fill_push(value * 0x010101u, len, flags);
+}
@@ -0,0 +1,49 @@
+#ifndef LCD_DMA_H
+#define LCD_DMA_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Asynchronous pixel transfer engine for the LCD SPI bus.
+// Jobs are queued in order and shifted out by DMA; each job gets a fence
+// number that can be polled or waited on, and an optional callback that runs
+// (from the DMA interrupt) once its last byte has been handed to the SPI.
+// The interrupt never waits for the SPI to drain: CS of a job that ends a
+// transaction goes up there if the SPI is already idle, else in lcd_dma_wait_idle().
+
+#define LCD_DMA_QUEUE_LEN   8
+#define LCD_DMA_FILL_PIXELS 128     // pixels per repeating fill block
+
+#define LCD_DMA_END         0x0001  // finish the SPI transaction (raise CS) after this job
+
+typedef uint32_t lcd_fence_t;
+typedef void (*lcd_dma_callback_t)(lcd_fence_t fence, void *arg);
+
+extern void lcd_dma_init(void);
+
+// src must stay valid until the returned fence has passed
+extern lcd_fence_t lcd_dma_send(const uint8_t *src, uint32_t len, uint16_t flags);
+extern lcd_fence_t lcd_dma_send_cb(const uint8_t *src, uint32_t len, uint16_t flags,
+                                   lcd_dma_callback_t cb, void *arg);
+// sends the 3 byte colour `colour` (RGB() value) `pixels` times
+extern lcd_fence_t lcd_dma_fill(uint32_t colour, uint32_t pixels, uint16_t flags);
+// sends `value` len times, for packed pixel formats
+extern lcd_fence_t lcd_dma_fill_bytes(uint8_t value, uint32_t len, uint16_t flags);
+
+extern bool lcd_dma_done(lcd_fence_t fence);
+extern void lcd_dma_wait(lcd_fence_t fence);
+extern void lcd_dma_wait_idle(void);
+extern bool lcd_dma_busy(void);
+extern lcd_fence_t lcd_dma_last_fence(void);
+
+#if !PICO_ON_DEVICE
+// Host builds have no DMA controller: jobs stay queued until they are
+// stepped, one block at a time, into the sink (spi_write_blocking by default).
+typedef void (*lcd_dma_sink_t)(const uint8_t *src, uint32_t len);
+extern void lcd_dma_mock_set_sink(lcd_dma_sink_t sink);
+extern bool lcd_dma_mock_step(void);
+extern int  lcd_dma_mock_pending(void);
+#endif
+
+#endif
@@ -0,0 +1,10 @@
+#include "lcd_driver.hpp"
+
+// Widths of the nibble glyph sets lcdspi/CMakeLists.txt compiles in: lcd_font_main,
+// lcd_font_main_x2 and lcd_font_battery. Any other width takes the generic path.
+using nibble_widths = std::integer_sequence<int, 8, 16, 38>;
+
+extern "C" lcd_glyph_row_fn lcd_driver_glyph_row(const lcd_glyphs_t *g) {
+    if (g->layout != LCD_GLYPHS_NIBBLE) return nullptr;
+    return lcd::pick_nibble_row(g->width, nibble_widths{});
+}
@@ -0,0 +1,41 @@
+#ifndef LCD_DRIVER_H
+#define LCD_DRIVER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "lcd_glyphs.h"
+
+// The render core's per-pixel loops compiled for fixed parameters (lcd_driver.cpp):
+// each is a C++ template over the glyph width, so the loops over a glyph row unroll
+// and copy in fixed sizes of panel-order R,G,B pixels. The instances are picked
+// once per text run; anything without one takes the generic path in lcdspi.c.
+// 0 builds only the generic path, e.g. to compare against (host/CMakeLists.txt).
+#ifndef LCD_USE_DRIVER_TEMPLATES
+#define LCD_USE_DRIVER_TEMPLATES 1
+#endif
+
+// Colours of the text being drawn, as copied into rows: every four pixel piece a
+// nibble of a glyph row can stand for, and a glyph width of each colour.
+typedef struct {
+    uint32_t fc, bc;
+    bool set;
+    unsigned char nib[16][12];
+    unsigned char fg[LCD_GLYPHS_MAX_W * 3], bg[LCD_GLYPHS_MAX_W * 3];
+} lcd_pen_t;
+
+// builds a whole glyph row at q, returns the end
+typedef unsigned char *(*lcd_glyph_row_fn)(const lcd_pen_t *pen, const uint8_t *row, unsigned char *q);
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// the instance for glyph set g, NULL if there is none
+extern lcd_glyph_row_fn lcd_driver_glyph_row(const lcd_glyphs_t *g);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
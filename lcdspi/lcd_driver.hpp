@@ -0,0 +1,44 @@
+#ifndef LCD_DRIVER_HPP
+#define LCD_DRIVER_HPP
+
+#include <cstring>
+#include <utility>
+
+#include "lcd_driver.h"
+
+// Templates behind lcd_driver.h. The parameters are what the row builders would
+// otherwise look up or compute for every piece: how wide a glyph is, how its rows
+// are laid out.
+
+namespace lcd {
+
+// one row of a LCD_GLYPHS_NIBBLE glyph W pixels wide: W / 4 pieces of 12 bytes
+// from the pen, then the part of a piece a width not divisible by 4 leaves
+template <int W>
+unsigned char *nibble_row(const lcd_pen_t *pen, const uint8_t *row, unsigned char *q) {
+    static_assert(W > 0 && W <= LCD_GLYPHS_MAX_W, "glyph width");
+    for (int k = 0; k < W / 4; k++) {
+        uint8_t v = k & 1 ? row[k >> 1] & 0x0F : row[k >> 1] >> 4;
+        std::memcpy(q, pen->nib[v], 4 * 3);
+        q += 4 * 3;
+    }
+    if constexpr (W % 4 != 0) {
+        constexpr int k = W / 4;
+        uint8_t v = k & 1 ? row[k >> 1] & 0x0F : row[k >> 1] >> 4;
+        std::memcpy(q, pen->nib[v], (W % 4) * 3);
+        q += (W % 4) * 3;
+    }
+    return q;
+}
+
+// the instance for width w out of the widths Ws it is compiled for
+template <int... Ws>
+lcd_glyph_row_fn pick_nibble_row(int w, std::integer_sequence<int, Ws...>) {
+    lcd_glyph_row_fn fn = nullptr;
+    ((fn = w == Ws ? nibble_row<Ws> : fn), ...);
+    return fn;
+}
+
+}
+
+#endif
@@ -0,0 +1,76 @@
+#include "lcdspi.h"
+#include "lcd_psram.h"
+#include "lcd_shadow.h"
+#include "lcd_framecache.h"
+
+typedef struct {
+    bool valid;
+    uint32_t gen;
+    int x1, y1, x2, y2;
+    volatile uint8_t packable;      // set by the render core once the copy is made
+} frame_t;
+
+static frame_t frames[LCD_FRAME_SLOTS];
+
+static inline uint32_t slot_addr(int slot) {
+    return LCD_FRAME_BASE + slot * LCD_FRAME_SLOT_BYTES;
+}
+
+static bool clip(int *x1, int *y1, int *x2, int *y2) {
+    if (*x1 < 0) *x1 = 0;
+    if (*y1 < 0) *y1 = 0;
+    if (*x2 >= LCD_WIDTH) *x2 = LCD_WIDTH - 1;
+    if (*y2 >= LCD_HEIGHT) *y2 = LCD_HEIGHT - 1;
+    return *x1 <= *x2 && *y1 <= *y2;
+}
+
+static bool same_area(const frame_t *f, int x1, int y1, int x2, int y2) {
+    return f->x1 == x1 && f->y1 == y1 && f->x2 == x2 && f->y2 == y2;
+}
+
+bool lcd_frame_store(int slot, uint32_t gen, int x1, int y1, int x2, int y2) {
+    if (slot < 0 || slot >= LCD_FRAME_SLOTS || !clip(&x1, &y1, &x2, &y2)) return false;
+#if LCD_USE_PSRAM_SHADOW
+    if (!lcd_shadow_active()) return false;
+    frame_t *f = &frames[slot];
+    if (f->valid && f->gen == gen && same_area(f, x1, y1, x2, y2)) return true;
+    *f = (frame_t) {true, gen, x1, y1, x2, y2, 0};
+    save_buffer_psram(x1, y1, x2, y2, slot_addr(slot), &f->packable);
+    return true;
+#else
+    return false;
+#endif
+}
+
+static frame_t *lookup(int slot, uint32_t gen, int x1, int y1, int x2, int y2) {
+    if (slot < 0 || slot >= LCD_FRAME_SLOTS || !clip(&x1, &y1, &x2, &y2)) return NULL;
+    frame_t *f = &frames[slot];
+    return f->valid && f->gen == gen && same_area(f, x1, y1, x2, y2) ? f : NULL;
+}
+
+uint32_t lcd_frame_cost(int slot, uint32_t gen, int x1, int y1, int x2, int y2) {
+    const frame_t *f = lookup(slot, gen, x1, y1, x2, y2);
+    if (!f) return 0;
+    uint32_t pixels = (uint32_t) (f->x2 - f->x1 + 1) * (f->y2 - f->y1 + 1);
+    // a copy still queued counts as 18 bit
+    return f->packable ? (pixels + 1) / 2 : pixels * 3;
+}
+
+bool lcd_frame_show(int slot, uint32_t gen, int x1, int y1, int x2, int y2) {
+    frame_t *f = lookup(slot, gen, x1, y1, x2, y2);
+    if (!f) return false;
+#if LCD_USE_PSRAM_SHADOW
+    draw_buffer_psram(f->x1, f->y1, f->x2, f->y2, slot_addr(slot), &f->packable);
+    return true;
+#else
+    return false;
+#endif
+}
+
+void lcd_frame_evict(int slot) {
+    if (slot >= 0 && slot < LCD_FRAME_SLOTS) frames[slot].valid = false;
+}
+
+void lcd_frame_reclaim(uint32_t top) {
+    for (int i = 0; i < LCD_FRAME_SLOTS && slot_addr(i) < top; i++) frames[i].valid = false;
+}
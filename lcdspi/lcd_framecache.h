@@ -0,0 +1,30 @@
+#ifndef LCD_FRAMECACHE_H
+#define LCD_FRAMECACHE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Pictures of screen areas kept in PSRAM, each in a numbered slot together with the
+// generation of whatever it shows, so a screen that has not changed since can be
+// streamed back instead of being drawn again. Pictures are copied from the PSRAM
+// shadow by the render core and need no SRAM. The slots sit at the top of PSRAM and
+// are given up when save-unders need the room; without the shadow nothing is kept
+// and every lookup misses.
+
+#define LCD_FRAME_SLOTS         4
+#define LCD_FRAME_SLOT_BYTES    (LCD_WIDTH * LCD_HEIGHT * 3)
+#define LCD_FRAME_BASE          (LCD_PSRAM_SIZE - LCD_FRAME_SLOTS * LCD_FRAME_SLOT_BYTES)
+
+// keeps x1..y2 as it will be once everything queued so far is drawn, as slot's
+// picture of generation gen; nothing is copied if the slot already holds that
+extern bool lcd_frame_store(int slot, uint32_t gen, int x1, int y1, int x2, int y2);
+// bytes drawing the slot's picture would send to the panel (in LCD_PIXFMT_AUTO), 0
+// unless it is of generation gen and the area x1..y2
+extern uint32_t lcd_frame_cost(int slot, uint32_t gen, int x1, int y1, int x2, int y2);
+// draws the slot's picture if it is of generation gen and the area x1..y2
+extern bool lcd_frame_show(int slot, uint32_t gen, int x1, int y1, int x2, int y2);
+extern void lcd_frame_evict(int slot);
+// gives up the slots that lie below PSRAM address top
+extern void lcd_frame_reclaim(uint32_t top);
+
+#endif
@@ -0,0 +1,6 @@
+#include <stddef.h>
+
+#include "lcd_glyphs.h"
+
+// the tables, generated into the build directory from fonts/ by tools/fontc.py
+#include "lcd_glyph_sets.h"
@@ -0,0 +1,66 @@
+#ifndef LCD_GLYPHS_H
+#define LCD_GLYPHS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+// Glyph sets compiled from the bitmap fonts in fonts/ at build time by
+// tools/fontc.py (see CMakeLists.txt), each already at the size it is drawn at.
+// Rows come in one of two layouts, both copied by the text renderer in whole
+// pieces rather than pixel by pixel:
+//   LCD_GLYPHS_NIBBLE  (width + 3) / 4 nibbles a row, high nibble first, bit 3 the
+//                      leftmost pixel; every row starts on a byte
+//   LCD_GLYPHS_RLE     a count byte, then that many run lengths adding up to the
+//                      width, alternately background and foreground, background
+//                      first; offset[] gives the first row of each glyph
+
+#define LCD_GLYPHS_MAX_W    64
+
+enum {
+    LCD_GLYPHS_NIBBLE,
+    LCD_GLYPHS_RLE,
+};
+
+typedef struct lcd_glyphs {
+    uint8_t width, height;
+    uint8_t first, count;       // characters first .. first + count - 1, unless chars is set
+    uint8_t layout;
+    const char *chars;          // the count characters the set holds, in order
+    const uint16_t *offset;     // LCD_GLYPHS_RLE only
+    const uint8_t *data;
+} lcd_glyphs_t;
+
+extern const lcd_glyphs_t lcd_font_main;        // font1, 8x12
+extern const lcd_glyphs_t lcd_font_main_x2;     // font1, 16x24
+extern const lcd_glyphs_t lcd_font_digits;      // font1 at three times, the characters of a result
+extern const lcd_glyphs_t lcd_font_battery;     // battery levels '0'..'9', 38x19
+
+// glyph number of c, -1 when the set does not have it
+static inline int lcd_glyph_index(const lcd_glyphs_t *g, unsigned char c) {
+    if (g->chars) {
+        const char *p = c ? (const char *) memchr(g->chars, c, g->count) : NULL;
+        return p ? (int) (p - g->chars) : -1;
+    }
+    return c >= g->first && c < g->first + g->count ? c - g->first : -1;
+}
+
+static inline const uint8_t *lcd_glyph_row0(const lcd_glyphs_t *g, int idx) {
+    if (g->layout == LCD_GLYPHS_RLE) return g->data + g->offset[idx];
+    return g->data + idx * g->height * ((g->width + 7) / 8);
+}
+
+static inline const uint8_t *lcd_glyph_next_row(const lcd_glyphs_t *g, const uint8_t *row) {
+    if (g->layout == LCD_GLYPHS_RLE) return row + 1 + row[0];
+    return row + (g->width + 7) / 8;
+}
+
+// row r of glyph idx; RLE rows have to be walked to
+static inline const uint8_t *lcd_glyph_row(const lcd_glyphs_t *g, int idx, int r) {
+    const uint8_t *row = lcd_glyph_row0(g, idx);
+    if (g->layout != LCD_GLYPHS_RLE) return row + r * ((g->width + 7) / 8);
+    while (r-- > 0) row = lcd_glyph_next_row(g, row);
+    return row;
+}
+
+#endif
@@ -0,0 +1,94 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "pico/stdlib.h"
+#if PICO_ON_DEVICE
+#include "psram_spi.h"
+#endif
+
+#include "lcd_psram.h"
+
+// The PIO program takes 8 bit bit-counts, so one write carries at most
+// (4 + 27) * 8 = 248 bits and one read 31 * 8 = 248 bits. Transfers are also
+// kept inside 1KB pages, which the PSRAM wraps bursts around.
+#define PSRAM_WRITE_CHUNK 27
+#define PSRAM_READ_CHUNK  31
+#define PSRAM_PAGE        1024
+
+static bool ready = false;
+
+static uint32_t chunk_len(uint32_t addr, uint32_t len, uint32_t max) {
+    uint32_t n = PSRAM_PAGE - (addr % PSRAM_PAGE);
+    if (n > max) n = max;
+    return len < n ? len : n;
+}
+
+#if PICO_ON_DEVICE
+
+static psram_spi_inst_t psram;
+
+bool lcd_psram_init(void) {
+    if (ready) return true;
+    psram = psram_spi_init(pio1, -1);
+    // make sure a chip actually answers before anything keeps data in it
+    psram_write32(&psram, 0, 0x5AA5C33C);
+    ready = psram_read32(&psram, 0) == 0x5AA5C33C;
+    return ready;
+}
+
+void lcd_psram_write(uint32_t addr, const uint8_t *src, uint32_t len) {
+    while (len) {
+        uint32_t n = chunk_len(addr, len, PSRAM_WRITE_CHUNK);
+        psram_write(&psram, addr, src, n);
+        addr += n;
+        src += n;
+        len -= n;
+    }
+}
+
+void lcd_psram_read(uint32_t addr, uint8_t *dst, uint32_t len) {
+    while (len) {
+        uint32_t n = chunk_len(addr, len, PSRAM_READ_CHUNK);
+        psram_read(&psram, addr, dst, n);
+        addr += n;
+        dst += n;
+        len -= n;
+    }
+}
+
+#else
+
+static uint8_t *psram_mem = NULL;
+
+bool lcd_psram_init(void) {
+    if (!psram_mem) psram_mem = calloc(1, LCD_PSRAM_SIZE);
+    ready = psram_mem != NULL;
+    return ready;
+}
+
+// chunked like the device so transaction counts stay comparable
+void lcd_psram_write(uint32_t addr, const uint8_t *src, uint32_t len) {
+    while (len) {
+        uint32_t n = chunk_len(addr, len, PSRAM_WRITE_CHUNK);
+        memcpy(psram_mem + (addr % LCD_PSRAM_SIZE), src, n);
+        addr += n;
+        src += n;
+        len -= n;
+    }
+}
+
+void lcd_psram_read(uint32_t addr, uint8_t *dst, uint32_t len) {
+    while (len) {
+        uint32_t n = chunk_len(addr, len, PSRAM_READ_CHUNK);
+        memcpy(dst, psram_mem + (addr % LCD_PSRAM_SIZE), n);
+        addr += n;
+        dst += n;
+        len -= n;
+    }
+}
+
+#endif
+
+bool lcd_psram_ready(void) {
+    return ready;
+}
@@ -0,0 +1,18 @@
+#ifndef LCD_PSRAM_H
+#define LCD_PSRAM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Access to the PicoCalc's SPI PSRAM (via rp2040-psram) for display buffers.
+// Transfers of any length are split into the short transactions the PIO
+// program supports. Host builds get an emulated PSRAM held in ordinary memory.
+
+#define LCD_PSRAM_SIZE  (8 * 1024 * 1024)
+
+extern bool lcd_psram_init(void);
+extern bool lcd_psram_ready(void);
+extern void lcd_psram_write(uint32_t addr, const uint8_t *src, uint32_t len);
+extern void lcd_psram_read(uint32_t addr, uint8_t *dst, uint32_t len);
+
+#endif
@@ -0,0 +1,106 @@
+#ifndef LCD_QUEUE_H
+#define LCD_QUEUE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+// Single-producer/single-consumer ring of drawing commands. Only the producer
+// reserves and publishes slots and only the consumer peeks and releases them, so
+// the two indices are all that is shared and no lock is needed. Plain C11 with no
+// SDK dependency, so it builds and can be stress-tested with two threads on a PC.
+
+#define LCD_RENDER_QUEUE_LEN    32      // power of two
+#define LCD_CMD_TEXT_MAX        40      // one full line of the 8 pixel wide font
+#define LCD_CMD_PIXELS_MAX      16
+
+enum {
+    LCD_CMD_RECT,           // x1..y2 filled with fc
+    LCD_CMD_PIXELS,         // len points in fc
+    LCD_CMD_LINE,           // x1, y1 to x2, y2 in fc
+    LCD_CMD_TEXT,           // len characters of font at x1, y1 in fc on bc
+    LCD_CMD_BLIT,           // [B,G,R] pixels from data into x1..y2
+    LCD_CMD_ROWS,           // x1..y2 built a row at a time by row(row_arg, ...), len: all 3 bit
+    LCD_CMD_READ,           // x1..y2 read back into data as [B,G,R] pixels
+    LCD_CMD_SAVE,           // x1..y2 copied from the PSRAM shadow to PSRAM at addr
+    LCD_CMD_RESTORE,        // x1..y2 drawn from PSRAM at addr, as LCD_CMD_SAVE left it
+    LCD_CMD_BITMAP,         // 1bpp data, x2 by y2 pixels, drawn at x1, y1 scaled by scale
+    LCD_CMD_SCROLL,         // scroll by x1 lines, filling with bc
+    LCD_CMD_SCROLL_RESET,
+    LCD_CMD_CALL,           // fn(arg) on the render core
+    LCD_CMD_BAND_BEGIN,     // keep what follows for the band compositor (lcd_band.h)
+    LCD_CMD_BAND_END,       // composite and send it
+};
+
+typedef struct {
+    int16_t x, y;
+} lcd_point_t;
+
+struct lcd_glyphs;
+
+typedef struct {
+    uint8_t op;
+    uint8_t len;
+    int16_t x1, y1, x2, y2;
+    uint32_t fc, bc;
+    const struct lcd_glyphs *font;      // LCD_CMD_TEXT
+    union {
+        char text[LCD_CMD_TEXT_MAX];
+        lcd_point_t pts[LCD_CMD_PIXELS_MAX];
+        struct {
+            const uint8_t *data;
+            float scale;
+        };
+        struct {
+            uint32_t addr;
+            volatile uint8_t *packable;     // LCD_CMD_SAVE sets it, LCD_CMD_RESTORE reads it
+        };
+        struct {
+            void (*fn)(void *);
+            void *arg;
+        };
+        struct {
+            void (*row)(void *arg, int x1, int x2, int y, unsigned char *rgb);
+            void *row_arg;
+        };
+    };
+} lcd_cmd_t;
+
+typedef struct {
+    atomic_uint head;       // next slot to consume, only the consumer writes it
+    atomic_uint tail;       // next slot to fill, only the producer writes it
+    lcd_cmd_t slot[LCD_RENDER_QUEUE_LEN];
+} lcd_queue_t;
+
+// producer: the slot to fill next, NULL while the ring is full
+static inline lcd_cmd_t *lcd_queue_reserve(lcd_queue_t *q) {
+    unsigned t = atomic_load_explicit(&q->tail, memory_order_relaxed);
+    if (t - atomic_load_explicit(&q->head, memory_order_acquire) >= LCD_RENDER_QUEUE_LEN) return NULL;
+    return &q->slot[t % LCD_RENDER_QUEUE_LEN];
+}
+
+// producer: hands the reserved slot to the consumer
+static inline void lcd_queue_publish(lcd_queue_t *q) {
+    unsigned t = atomic_load_explicit(&q->tail, memory_order_relaxed);
+    atomic_store_explicit(&q->tail, t + 1, memory_order_release);
+}
+
+// consumer: the oldest published command, NULL while the ring is empty
+static inline const lcd_cmd_t *lcd_queue_peek(lcd_queue_t *q) {
+    unsigned h = atomic_load_explicit(&q->head, memory_order_relaxed);
+    if (h == atomic_load_explicit(&q->tail, memory_order_acquire)) return NULL;
+    return &q->slot[h % LCD_RENDER_QUEUE_LEN];
+}
+
+// consumer: gives the peeked slot back to the producer
+static inline void lcd_queue_release(lcd_queue_t *q) {
+    unsigned h = atomic_load_explicit(&q->head, memory_order_relaxed);
+    atomic_store_explicit(&q->head, h + 1, memory_order_release);
+}
+
+static inline bool lcd_queue_empty(lcd_queue_t *q) {
+    return atomic_load_explicit(&q->head, memory_order_acquire) ==
+           atomic_load_explicit(&q->tail, memory_order_acquire);
+}
+
+#endif
@@ -0,0 +1,169 @@
+#include <stdatomic.h>
+
+#include "pico/stdlib.h"
+#if PICO_ON_DEVICE
+#include "pico/multicore.h"
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "lcdspi.h"
+#include "lcd_dma.h"
+#include "lcd_render.h"
+
+static lcd_queue_t queue;
+static volatile bool running = false;
+static lcd_cmd_t *pending = NULL;       // reserved pixel command still taking points
+static lcd_cmd_t direct;                // commands run straight away use this
+static uint32_t issued = 0;             // commands published, core 0 only
+static atomic_uint done;                // commands finished, written by the server
+
+#if PICO_ON_DEVICE
+
+static inline bool on_render_core(void) {
+    return get_core_num() == 1;
+}
+
+static inline void wait_event(void) {
+    __wfe();
+}
+
+static inline void signal_event(void) {
+    __sev();
+}
+
+#else
+
+// set by the server thread itself before it touches the queue
+static _Thread_local bool render_thread = false;
+
+static inline bool on_render_core(void) {
+    return render_thread;
+}
+
+static inline void wait_event(void) {
+    sched_yield();
+}
+
+static inline void signal_event(void) {
+}
+
+#endif
+
+static void server_loop(void) {
+    uint32_t n = 0;
+    for (;;) {
+        const lcd_cmd_t *c = lcd_queue_peek(&queue);
+        if (!c) {
+            wait_event();
+            continue;
+        }
+        lcd_render_exec(c);
+        lcd_queue_release(&queue);
+        // the last command only counts as done once it is out on the bus, which is
+        // what lcd_render_sync() relies on
+        if (lcd_queue_empty(&queue)) lcd_dma_wait_idle();
+        atomic_store_explicit(&done, ++n, memory_order_release);
+        signal_event();
+    }
+}
+
+#if PICO_ON_DEVICE
+
+static void core1_main(void) {
+    // the DMA completion IRQ has to be taken on the core that queues the transfers
+    lcd_dma_init();
+    server_loop();
+}
+
+void lcd_render_start(void) {
+    if (running) return;
+    running = true;
+    multicore_launch_core1(core1_main);
+}
+
+#else
+
+static void *server_main(void *arg) {
+    render_thread = true;
+    lcd_dma_init();
+    server_loop();
+    return NULL;
+}
+
+void lcd_render_start(void) {
+    if (running) return;
+    running = true;
+    pthread_t thread;
+    pthread_create(&thread, NULL, server_main, NULL);
+}
+
+#endif
+
+bool lcd_render_running(void) {
+    return running;
+}
+
+lcd_cmd_t *lcd_render_cmd(uint8_t op) {
+    lcd_cmd_t *c;
+    if (!running || on_render_core()) {
+        c = &direct;
+    } else {
+        lcd_render_flush();
+        while (!(c = lcd_queue_reserve(&queue))) wait_event();
+    }
+    c->op = op;
+    return c;
+}
+
+void lcd_render_submit(lcd_cmd_t *cmd) {
+    if (cmd == &direct) {
+        lcd_render_exec(cmd);
+        return;
+    }
+    lcd_queue_publish(&queue);
+    issued++;
+    signal_event();
+}
+
+void lcd_render_pixel(int x, int y, uint32_t colour) {
+    if (pending && (pending->fc != colour || pending->len == LCD_CMD_PIXELS_MAX)) lcd_render_flush();
+    lcd_cmd_t *c = pending;
+    if (!c) {
+        c = lcd_render_cmd(LCD_CMD_PIXELS);
+        c->fc = colour;
+        c->len = 0;
+    }
+    c->pts[c->len].x = x;
+    c->pts[c->len].y = y;
+    c->len++;
+    if (c == &direct) lcd_render_exec(c);
+    else pending = c;
+}
+
+void lcd_render_flush(void) {
+    lcd_cmd_t *c = pending;
+    if (!c) return;
+    pending = NULL;
+    lcd_render_submit(c);
+}
+
+uint32_t lcd_render_fence(void) {
+    lcd_render_flush();
+    return issued;
+}
+
+void lcd_render_wait(uint32_t fence) {
+    // commands run straight away may still have transfers on the bus
+    if (!running || on_render_core()) {
+        lcd_dma_wait_idle();
+        return;
+    }
+    while ((int32_t) (atomic_load_explicit(&done, memory_order_acquire) - fence) < 0)
+        wait_event();
+}
+
+void lcd_render_sync(void) {
+    lcd_render_wait(lcd_render_fence());
+}
@@ -0,0 +1,35 @@
+#ifndef LCD_RENDER_H
+#define LCD_RENDER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "lcd_queue.h"
+
+// Render server. Once lcd_render_start() has run, the drawing calls in lcdspi.h
+// only queue a command on core 0 and core 1 does all panel and DMA traffic.
+// Commands run in the order they were queued. Before that, or on the render core
+// itself, commands run straight away.
+
+extern void lcd_render_start(void);
+extern bool lcd_render_running(void);
+
+// cmd = lcd_render_cmd(op), fill it in, then lcd_render_submit(cmd)
+extern lcd_cmd_t *lcd_render_cmd(uint8_t op);
+extern void lcd_render_submit(lcd_cmd_t *cmd);
+// single pixels in one colour are gathered into one LCD_CMD_PIXELS command
+extern void lcd_render_pixel(int x, int y, uint32_t colour);
+
+// hands over anything still being gathered
+extern void lcd_render_flush(void);
+// fence covering everything queued so far
+extern uint32_t lcd_render_fence(void);
+extern void lcd_render_wait(uint32_t fence);
+// waits until every command has run and the bus is idle; core 0 may then touch
+// the panel directly
+extern void lcd_render_sync(void);
+
+// carries out one command, on whichever core runs it (lcdspi.c)
+extern void lcd_render_exec(const lcd_cmd_t *cmd);
+
+#endif
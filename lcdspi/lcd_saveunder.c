@@ -0,0 +1,67 @@
+#include <stdlib.h>
+
+#include "lcdspi.h"
+#include "lcd_psram.h"
+#include "lcd_shadow.h"
+#include "lcd_saveunder.h"
+#include "lcd_framecache.h"
+
+static lcd_save_t saves[LCD_SAVE_DEPTH];
+static int depth = 0;
+
+static uint32_t save_bytes(const lcd_save_t *s) {
+    return (uint32_t) (s->x2 - s->x1 + 1) * (s->y2 - s->y1 + 1) * 3;
+}
+
+// first free PSRAM address, saves kept in SRAM take none
+static uint32_t psram_top(void) {
+    for (int i = depth - 1; i >= 0; i--) {
+        if (!saves[i].pixels) return saves[i].addr + save_bytes(&saves[i]);
+    }
+    return LCD_SAVE_BASE;
+}
+
+lcd_save_t *lcd_save_under(int x1, int y1, int x2, int y2) {
+    if (x1 < 0) x1 = 0;
+    if (y1 < 0) y1 = 0;
+    if (x2 >= LCD_WIDTH) x2 = LCD_WIDTH - 1;
+    if (y2 >= LCD_HEIGHT) y2 = LCD_HEIGHT - 1;
+    if (depth == LCD_SAVE_DEPTH || x2 < x1 || y2 < y1) return NULL;
+    lcd_save_t *s = &saves[depth];
+    s->x1 = x1;
+    s->y1 = y1;
+    s->x2 = x2;
+    s->y2 = y2;
+    s->pixels = NULL;
+    s->addr = psram_top();
+#if LCD_USE_PSRAM_SHADOW
+    if (lcd_shadow_active() && s->addr + save_bytes(s) <= LCD_PSRAM_SIZE) {
+        // cached frames in the way are cheaper to lose than a redraw after the popup
+        lcd_frame_reclaim(s->addr + save_bytes(s));
+        save_buffer_psram(x1, y1, x2, y2, s->addr, &s->packable);
+        depth++;
+        return s;
+    }
+#endif
+    if (save_bytes(s) > LCD_SAVE_SRAM_MAX || !(s->pixels = malloc(save_bytes(s)))) return NULL;
+    read_buffer_spi(x1, y1, x2, y2, s->pixels);
+    depth++;
+    return s;
+}
+
+void lcd_save_drop(lcd_save_t *s) {
+    // anything saved after s goes with it
+    while (depth > s - saves) {
+        depth--;
+        free(saves[depth].pixels);
+        saves[depth].pixels = NULL;
+    }
+}
+
+void lcd_save_restore(lcd_save_t *s) {
+    if (s->pixels) draw_buffer_spi(s->x1, s->y1, s->x2, s->y2, s->pixels);
+#if LCD_USE_PSRAM_SHADOW
+    else draw_buffer_psram(s->x1, s->y1, s->x2, s->y2, s->addr, &s->packable);
+#endif
+    lcd_save_drop(s);
+}
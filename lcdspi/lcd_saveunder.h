@@ -0,0 +1,33 @@
+#ifndef LCD_SAVEUNDER_H
+#define LCD_SAVEUNDER_H
+
+#include <stdint.h>
+
+// Save-under for popups: what a rectangle shows is kept before something is drawn
+// over it, and put back as one write window when that goes. With the PSRAM shadow
+// the render core copies the pixels into PSRAM behind the shadow, a row at a time;
+// otherwise they are read back into a heap buffer of at most LCD_SAVE_SRAM_MAX bytes.
+// PSRAM saves take the room of cached frames (lcd_framecache.h) if they need it.
+// Saves nest: each is restored or dropped before the one taken before it, and the
+// scroll state must not change while one is kept.
+
+#define LCD_SAVE_DEPTH      4
+#define LCD_SAVE_SRAM_MAX   (48 * 1024)
+#define LCD_SAVE_BASE       (LCD_SHADOW_BASE + LCD_SHADOW_SIZE)     // PSRAM for saves
+
+typedef struct {
+    int x1, y1, x2, y2;
+    uint8_t *pixels;        // [B,G,R] in SRAM, NULL when the copy is in PSRAM
+    uint32_t addr;          // PSRAM copy, LCD_SAVE_BASE and up
+    volatile uint8_t packable;
+} lcd_save_t;
+
+// x1..y2 inclusive, clipped to the screen; NULL when there is nowhere to keep it,
+// and the caller has to redraw what the popup covered instead
+extern lcd_save_t *lcd_save_under(int x1, int y1, int x2, int y2);
+// puts the pixels back and forgets the save
+extern void lcd_save_restore(lcd_save_t *s);
+// forgets the save, for when the screen is redrawn anyway
+extern void lcd_save_drop(lcd_save_t *s);
+
+#endif
@@ -0,0 +1,48 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "lcdspi.h"
+#include "lcd_render.h"
+#include "lcd_bmp.h"
+#include "lcd_screenshot.h"
+
+#define BAND_BYTES  (LCD_WIDTH * 3 * LCD_SHOT_BAND)
+
+bool lcd_screenshot(const char *path) {
+    uint8_t hdr[LCD_BMP_HEADER];
+    uint8_t *band[2] = {malloc(BAND_BYTES), malloc(BAND_BYTES)};
+    FILE *f = band[0] && band[1] ? fopen(path, "wb") : NULL;
+    bool ok = f != NULL;
+
+    lcd_bmp_header(hdr, LCD_WIDTH, LCD_HEIGHT);
+    if (ok) ok = fwrite(hdr, 1, sizeof(hdr), f) == sizeof(hdr);
+    uint32_t fence = ok ? read_buffer_spi_async(0, 0, LCD_WIDTH - 1, LCD_SHOT_BAND - 1, band[0])
+                        : lcd_render_fence();
+    for (int y = 0, i = 0; ok && y < LCD_HEIGHT; y += LCD_SHOT_BAND, i ^= 1) {
+        int n = LCD_HEIGHT - y < LCD_SHOT_BAND ? LCD_HEIGHT - y : LCD_SHOT_BAND;
+        lcd_render_wait(fence);
+        // the next band is read while this one goes to the card
+        int next = y + LCD_SHOT_BAND;
+        if (next < LCD_HEIGHT) {
+            int last = next + LCD_SHOT_BAND - 1 < LCD_HEIGHT ? next + LCD_SHOT_BAND - 1 : LCD_HEIGHT - 1;
+            fence = read_buffer_spi_async(0, next, LCD_WIDTH - 1, last, band[i ^ 1]);
+        }
+        ok = lcd_bmp_write_rows(f, band[i], LCD_WIDTH, n);
+    }
+    // a read may still be going into a buffer after a write failed
+    lcd_render_wait(fence);
+    if (f && fclose(f) != 0) ok = false;
+    free(band[0]);
+    free(band[1]);
+    return ok;
+}
+
+bool lcd_screenshot_name(const char *dir, char *path, size_t size) {
+    for (int i = 0; i < 1000; i++) {
+        snprintf(path, size, "%s/scr_%03d.bmp", dir, i);
+        FILE *f = fopen(path, "rb");
+        if (!f) return true;
+        fclose(f);
+    }
+    return false;
+}
@@ -0,0 +1,19 @@
+#ifndef LCD_SCREENSHOT_H
+#define LCD_SCREENSHOT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Screenshots as 24 bit BMP files, streamed a band of LCD_SHOT_BAND rows at a time:
+// the render core reads the next band back from the panel (or the PSRAM shadow)
+// while the calling core writes the previous one to the file, so two band buffers
+// are all the memory a capture takes.
+
+#define LCD_SHOT_BAND   16
+
+// the visible screen, as it is once everything queued so far has been drawn
+extern bool lcd_screenshot(const char *path);
+// first <dir>/scr_NNN.bmp that does not exist yet, false once all 1000 do
+extern bool lcd_screenshot_name(const char *dir, char *path, size_t size);
+
+#endif
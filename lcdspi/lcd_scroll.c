@@ -0,0 +1,76 @@
+#include "pico/stdlib.h"
+
+#include "lcdspi.h"
+#include "lcd_scroll.h"
+#include "lcd_render.h"
+
+#define TFT_VSCRDEF  0x33
+#define TFT_VSCRSADD 0x37
+
+static int rows = LCD_HEIGHT;   // height of the scroll area, it always starts at row 0
+static int offset = 0;          // panel row shown at the top of the scroll area
+static bool defined = false;    // VSCRDEF sent since reset
+
+static void send_u16(int v) {
+    spi_write_data(v >> 8);
+    spi_write_data(v & 0xFF);
+}
+
+static void send_start(void) {
+    spi_write_command(TFT_VSCRSADD);
+    send_u16(offset);
+}
+
+void lcd_scroll_define(int n) {
+    // core 0 reads the area height back straight away, so this is not queued
+    lcd_render_sync();
+    if (n < 1) n = 1;
+    if (n > LCD_HEIGHT) n = LCD_HEIGHT;
+    if (defined && n == rows && offset == 0) return;
+    defined = true;
+    rows = n;
+    offset = 0;
+    spi_write_command(TFT_VSCRDEF);
+    send_u16(0);
+    send_u16(rows);
+    send_u16(LCD_PANEL_ROWS - rows);
+    send_start();
+}
+
+void lcd_scroll_reset(void) {
+    if (offset == 0) return;
+    offset = 0;
+    send_start();
+}
+
+void lcd_scroll_by(int lines) {
+    offset = (offset + lines) % rows;
+    if (offset < 0) offset += rows;
+    send_start();
+}
+
+int lcd_scroll_rows(void) {
+    return rows;
+}
+
+int lcd_scroll_offset(void) {
+    return offset;
+}
+
+int lcd_scroll_phys_y(int y) {
+    if (y < 0 || y >= rows) return y;
+    y += offset;
+    return y >= rows ? y - rows : y;
+}
+
+int lcd_scroll_run(int y) {
+    if (y < 0 || y >= rows) return LCD_PANEL_ROWS - y;
+    return y < rows - offset ? rows - offset - y : rows - y;
+}
+
+#if !PICO_ON_DEVICE
+int lcd_scroll_mock_shown_row(int tfa, int vsa, int vsp, int line) {
+    if (line < tfa || line >= tfa + vsa) return line;
+    return tfa + (line - tfa + vsp - tfa + vsa) % vsa;
+}
+#endif
@@ -0,0 +1,33 @@
+#ifndef LCD_SCROLL_H
+#define LCD_SCROLL_H
+
+#include <stdbool.h>
+
+// Hardware vertical scrolling (VSCRDEF 0x33 / VSCRSADD 0x37). Screen rows
+// [0, rows) form the scroll area and rotate through the same panel rows; everything
+// below is a fixed area (the tab bar). Drawing code works in logical rows and the
+// primitives map them to panel rows with lcd_scroll_phys_y().
+
+#define LCD_PANEL_ROWS  480     // rows of ILI9488 GRAM, only the first LCD_HEIGHT are visible
+
+// makes screen rows [0, rows) the scroll area and resets the scroll offset
+extern void lcd_scroll_define(int rows);
+// puts the scroll area back to offset 0, the caller redraws it
+extern void lcd_scroll_reset(void);
+// after this, logical row y shows what row y + lines showed before
+extern void lcd_scroll_by(int lines);
+extern int lcd_scroll_rows(void);
+extern int lcd_scroll_offset(void);
+
+extern int lcd_scroll_phys_y(int y);
+// how many logical rows from y on are also consecutive panel rows
+extern int lcd_scroll_run(int y);
+
+#if !PICO_ON_DEVICE
+// model of the panel: the GRAM row shown on visible line `line` for the VSCRDEF top
+// fixed area tfa and scroll area vsa and the VSCRSADD start vsp, as the datasheet
+// describes it; the panel model of host/panel.c shows its pixels through this
+extern int lcd_scroll_mock_shown_row(int tfa, int vsa, int vsp, int line);
+#endif
+
+#endif
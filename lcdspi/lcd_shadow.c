@@ -0,0 +1,50 @@
+#include "pico/stdlib.h"
+
+#include "lcdspi.h"
+#include "lcd_psram.h"
+#include "lcd_shadow.h"
+
+#if LCD_USE_PSRAM_SHADOW
+
+static bool active = false;
+static uint8_t fill_row[LCD_WIDTH * 3];
+static uint32_t fill_row_colour = 0xFFFFFFFF;
+
+static inline uint32_t pixel_addr(int x, int y) {
+    return LCD_SHADOW_BASE + (y * LCD_WIDTH + x) * 3;
+}
+
+bool lcd_shadow_init(void) {
+    active = lcd_psram_init();
+    return active;
+}
+
+bool lcd_shadow_active(void) {
+    return active;
+}
+
+void lcd_shadow_write(int x, int y, const uint8_t *px, int n) {
+    if (!active) return;
+    lcd_psram_write(pixel_addr(x, y), px, n * 3);
+}
+
+void lcd_shadow_read(int x, int y, uint8_t *px, int n) {
+    lcd_psram_read(pixel_addr(x, y), px, n * 3);
+}
+
+void lcd_shadow_fill(int x1, int y1, int x2, int y2, uint32_t colour) {
+    if (!active) return;
+    int n = x2 - x1 + 1;
+    if (fill_row_colour != colour) {
+        uint8_t *p = fill_row;
+        for (int i = 0; i < LCD_WIDTH; i++) {
+            *p++ = colour >> 16;
+            *p++ = (colour >> 8) & 0xFF;
+            *p++ = colour & 0xFF;
+        }
+        fill_row_colour = colour;
+    }
+    for (int y = y1; y <= y2; y++) lcd_psram_write(pixel_addr(x1, y), fill_row, n * 3);
+}
+
+#endif
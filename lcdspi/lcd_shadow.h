@@ -0,0 +1,22 @@
+#ifndef LCD_SHADOW_H
+#define LCD_SHADOW_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Full-colour copy of the panel contents kept in PSRAM, 3 bytes per pixel in
+// the order they are sent to the panel. Lets save-under and screenshots read
+// pixels back without the slow LCD readback. Rows are panel GRAM rows, not
+// logical screen rows, so hardware scrolling needs no update here.
+
+#define LCD_SHADOW_BASE  0      // PSRAM address of the shadow
+#define LCD_SHADOW_SIZE  (LCD_WIDTH * LCD_HEIGHT * 3)
+
+extern bool lcd_shadow_init(void);
+extern bool lcd_shadow_active(void);
+// n pixels of panel-order bytes starting at (x, y), within one row
+extern void lcd_shadow_write(int x, int y, const uint8_t *px, int n);
+extern void lcd_shadow_read(int x, int y, uint8_t *px, int n);
+extern void lcd_shadow_fill(int x1, int y1, int x2, int y2, uint32_t colour);
+
+#endif
@@ -0,0 +1,286 @@
+#include <string.h>
+
+#include "lcdspi.h"
+#include "lcd_render.h"
+#include "lcd_psram.h"
+#include "lcd_shadow.h"
+#include "lcd_saveunder.h"
+#include "lcd_framecache.h"
+#include "lcd_sprite.h"
+
+// PSRAM for images: above the most save-unders can take, below the cached frames
+#define ASSET_BASE  (LCD_SAVE_BASE + LCD_SAVE_DEPTH * LCD_WIDTH * LCD_HEIGHT * 3)
+#define ASSET_TOP   LCD_FRAME_BASE
+
+// a rectangle is sent as its own window unless merging it with another adds fewer
+// than this many pixels
+#define MERGE_SLACK 64
+
+typedef struct {
+    int16_t x1, y1, x2, y2;
+} rect_t;
+
+typedef struct {
+    const lcd_image_t *img;
+    int x, y, frame;
+} placed_t;
+
+// what the render core composites from: the sprites as they were when the frame
+// was presented, so the next one can be set up meanwhile
+typedef struct {
+    placed_t sprite[LCD_SPRITE_MAX];
+    int n;
+} frame_t;
+
+static struct {
+    bool open;
+    rect_t area;
+    const lcd_image_t *tiles;
+    uint8_t *map;
+    int cols;
+    uint32_t bg;
+    uint8_t bg_rgb[3];
+    lcd_sprite_t sprite[LCD_SPRITE_MAX];
+    placed_t shown[LCD_SPRITE_MAX];     // each slot as last presented, img NULL if nothing
+    rect_t dirty[LCD_STAGE_DIRTY_MAX];
+    int ndirty;
+    frame_t frame[2];
+    uint32_t fence[2];
+    int cur;
+} stage;
+
+static uint32_t asset_top = ASSET_BASE;
+static uint8_t src_row[LCD_WIDTH * 3];     // render core: an image row read from PSRAM
+
+static bool colour_pure(uint32_t c) {
+    for (int i = 0; i < 24; i += 8) {
+        if (((c >> i) & 0xFF) != 0 && ((c >> i) & 0xFF) != 0xFF) return false;
+    }
+    return true;
+}
+
+void lcd_image_init(lcd_image_t *img, int w, int h, int frames, uint32_t key, const uint8_t *pixels) {
+    img->w = w;
+    img->h = h;
+    img->frames = frames;
+    img->key = key;
+    img->pixels = pixels;
+    img->addr = 0;
+    img->packable = true;
+    const uint8_t *p = pixels;
+    for (int i = 0; i < w * h * frames && img->packable; i++, p += 3) {
+        uint32_t c = RGB(p[0], p[1], p[2]);
+        img->packable = c == key || colour_pure(c);
+    }
+}
+
+static void psram_copy_call(void *arg) {
+    lcd_image_t *img = arg;
+    lcd_psram_write(img->addr, img->pixels, (uint32_t) img->w * img->h * img->frames * 3);
+}
+
+bool lcd_image_to_psram(lcd_image_t *img) {
+    uint32_t bytes = (uint32_t) img->w * img->h * img->frames * 3;
+    if (!img->pixels || !lcd_psram_ready() || asset_top + bytes > ASSET_TOP) return false;
+    img->addr = asset_top;
+    asset_top += bytes;
+    // PSRAM is the render core's, so it makes the copy
+    lcd_cmd_t *cmd = lcd_render_cmd(LCD_CMD_CALL);
+    cmd->fn = psram_copy_call;
+    cmd->arg = img;
+    lcd_render_submit(cmd);
+    lcd_render_wait(lcd_render_fence());
+    img->pixels = NULL;
+    return true;
+}
+
+void lcd_image_release_all(void) {
+    asset_top = ASSET_BASE;
+}
+
+// Render core: n pixels of row sy of frame f from column sx on; from PSRAM they go
+// through src_row unless dst is given to read them into.
+static const uint8_t *image_row(const lcd_image_t *img, int f, int sy, int sx, int n, uint8_t *dst) {
+    uint32_t at = (((uint32_t) f * img->h + sy) * img->w + sx) * 3;
+    if (img->pixels) {
+        if (dst) memcpy(dst, img->pixels + at, n * 3);
+        return img->pixels + at;
+    }
+    if (!dst) dst = src_row;
+    lcd_psram_read(img->addr + at, dst, n * 3);
+    return dst;
+}
+
+// render core: builds x1..x2 of screen row y from the tiles and the frame's sprites
+static void compose_row(void *arg, int x1, int x2, int y, unsigned char *rgb) {
+    const frame_t *fr = arg;
+    int ry = y - stage.area.y1;
+    for (int x = x1; x <= x2;) {
+        int rx = x - stage.area.x1, n = x2 - x + 1;
+        uint8_t t = LCD_TILE_EMPTY;
+        if (stage.tiles) {
+            const lcd_image_t *ts = stage.tiles;
+            t = stage.map[ry / ts->h * stage.cols + rx / ts->w];
+            if (n > ts->w - rx % ts->w) n = ts->w - rx % ts->w;
+            if (t < ts->frames) image_row(ts, t, ry % ts->h, rx % ts->w, n, rgb + (x - x1) * 3);
+        }
+        if (t == LCD_TILE_EMPTY || !stage.tiles || t >= stage.tiles->frames) {
+            for (int i = 0; i < n; i++) memcpy(rgb + (x - x1 + i) * 3, stage.bg_rgb, 3);
+        }
+        x += n;
+    }
+    for (int i = 0; i < fr->n; i++) {
+        const placed_t *s = &fr->sprite[i];
+        const lcd_image_t *img = s->img;
+        if (y < s->y || y >= s->y + img->h || x2 < s->x || x1 >= s->x + img->w) continue;
+        int cx1 = s->x > x1 ? s->x : x1, cx2 = s->x + img->w - 1 < x2 ? s->x + img->w - 1 : x2;
+        unsigned char *dst = rgb + (cx1 - x1) * 3;
+        int n = cx2 - cx1 + 1;
+        if (img->key == LCD_IMAGE_OPAQUE) {
+            image_row(img, s->frame, y - s->y, cx1 - s->x, n, dst);
+            continue;
+        }
+        const uint8_t *p = image_row(img, s->frame, y - s->y, cx1 - s->x, n, NULL);
+        uint8_t kr = img->key >> 16, kg = (img->key >> 8) & 0xFF, kb = img->key & 0xFF;
+        for (int k = 0; k < n; k++, p += 3, dst += 3) {
+            if (p[0] != kr || p[1] != kg || p[2] != kb) memcpy(dst, p, 3);
+        }
+    }
+}
+
+static int area_of(const rect_t *r) {
+    return (r->x2 - r->x1 + 1) * (r->y2 - r->y1 + 1);
+}
+
+static rect_t rect_union(const rect_t *a, const rect_t *b) {
+    return (rect_t) {a->x1 < b->x1 ? a->x1 : b->x1, a->y1 < b->y1 ? a->y1 : b->y1,
+                     a->x2 > b->x2 ? a->x2 : b->x2, a->y2 > b->y2 ? a->y2 : b->y2};
+}
+
+// pixels a merge of a and b would send that the two alone would not
+static int merge_cost(const rect_t *a, const rect_t *b) {
+    rect_t u = rect_union(a, b);
+    return area_of(&u) - area_of(a) - area_of(b);
+}
+
+// adds r, clipped to the stage, merging it where that is cheap or the list is full
+static void add_dirty(rect_t r) {
+    const rect_t *a = &stage.area;
+    if (r.x1 < a->x1) r.x1 = a->x1;
+    if (r.y1 < a->y1) r.y1 = a->y1;
+    if (r.x2 > a->x2) r.x2 = a->x2;
+    if (r.y2 > a->y2) r.y2 = a->y2;
+    if (r.x1 > r.x2 || r.y1 > r.y2) return;
+    for (;;) {
+        int best = -1, cost = MERGE_SLACK;
+        for (int i = 0; i < stage.ndirty; i++) {
+            int c = merge_cost(&stage.dirty[i], &r);
+            if (c < cost || (best < 0 && stage.ndirty == LCD_STAGE_DIRTY_MAX)) {
+                best = i;
+                cost = c;
+            }
+        }
+        if (best < 0) break;
+        // the merged one may now be worth merging with another
+        r = rect_union(&stage.dirty[best], &r);
+        stage.dirty[best] = stage.dirty[--stage.ndirty];
+    }
+    stage.dirty[stage.ndirty++] = r;
+}
+
+static rect_t placed_rect(const placed_t *p) {
+    return (rect_t) {p->x, p->y, p->x + p->img->w - 1, p->y + p->img->h - 1};
+}
+
+static bool rect_packable(const rect_t *r, const frame_t *fr) {
+    if (!colour_pure(stage.bg) || (stage.tiles && !stage.tiles->packable)) return false;
+    for (int i = 0; i < fr->n; i++) {
+        rect_t s = placed_rect(&fr->sprite[i]);
+        if (!fr->sprite[i].img->packable && s.x1 <= r->x2 && s.x2 >= r->x1 && s.y1 <= r->y2 && s.y2 >= r->y1)
+            return false;
+    }
+    return true;
+}
+
+void lcd_stage_open(int x1, int y1, int x2, int y2, const lcd_image_t *tiles, uint8_t *map, int cols,
+                    uint32_t bg) {
+    lcd_stage_close();
+    if (x1 < 0) x1 = 0;
+    if (y1 < 0) y1 = 0;
+    if (x2 >= LCD_WIDTH) x2 = LCD_WIDTH - 1;
+    if (y2 >= LCD_HEIGHT) y2 = LCD_HEIGHT - 1;
+    stage.area = (rect_t) {x1, y1, x2, y2};
+    stage.tiles = map ? tiles : NULL;
+    stage.map = map;
+    stage.cols = cols;
+    stage.bg = bg;
+    stage.bg_rgb[0] = bg >> 16;
+    stage.bg_rgb[1] = (bg >> 8) & 0xFF;
+    stage.bg_rgb[2] = bg & 0xFF;
+    stage.open = x1 <= x2 && y1 <= y2;
+    stage.ndirty = 0;
+    add_dirty(stage.area);
+}
+
+void lcd_stage_close(void) {
+    if (stage.open) lcd_render_wait(stage.fence[stage.cur ^ 1]);
+    memset(stage.sprite, 0, sizeof(stage.sprite));
+    memset(stage.shown, 0, sizeof(stage.shown));
+    stage.open = false;
+}
+
+void lcd_stage_set_tile(int col, int row, uint8_t tile) {
+    const lcd_image_t *ts = stage.tiles;
+    if (!stage.open || !ts || col < 0 || col >= stage.cols || row < 0) return;
+    int x = stage.area.x1 + col * ts->w, y = stage.area.y1 + row * ts->h;
+    if (x > stage.area.x2 || y > stage.area.y2 || stage.map[row * stage.cols + col] == tile) return;
+    lcd_render_wait(stage.fence[stage.cur ^ 1]);
+    stage.map[row * stage.cols + col] = tile;
+    add_dirty((rect_t) {x, y, x + ts->w - 1, y + ts->h - 1});
+}
+
+void lcd_stage_invalidate(int x1, int y1, int x2, int y2) {
+    if (stage.open) add_dirty((rect_t) {x1, y1, x2, y2});
+}
+
+void lcd_stage_present(void) {
+    if (!stage.open) return;
+    frame_t *fr = &stage.frame[stage.cur];
+    // the render core may still be compositing the frame before last from this one
+    lcd_render_wait(stage.fence[stage.cur]);
+    fr->n = 0;
+    for (int i = 0; i < LCD_SPRITE_MAX; i++) {
+        const lcd_sprite_t *s = &stage.sprite[i];
+        // a slot that changed sends where it was and where it is
+        placed_t now = {NULL, s->x, s->y, s->frame}, *was = &stage.shown[i];
+        if (s->img && s->visible && s->frame >= 0 && s->frame < s->img->frames) now.img = s->img;
+        if (now.img != was->img || (now.img && (now.x != was->x || now.y != was->y || now.frame != was->frame))) {
+            if (was->img) add_dirty(placed_rect(was));
+            if (now.img) add_dirty(placed_rect(&now));
+            *was = now;
+        }
+        if (now.img) fr->sprite[fr->n++] = now;
+    }
+    for (int i = 0; i < stage.ndirty; i++) {
+        const rect_t *r = &stage.dirty[i];
+        stage.fence[stage.cur] = draw_rows_spi(r->x1, r->y1, r->x2, r->y2, compose_row, fr, rect_packable(r, fr));
+    }
+    stage.ndirty = 0;
+    stage.cur ^= 1;
+    lcd_render_flush();
+}
+
+lcd_sprite_t *lcd_sprite_add(const lcd_image_t *img, int x, int y) {
+    for (int i = 0; i < LCD_SPRITE_MAX; i++) {
+        lcd_sprite_t *s = &stage.sprite[i];
+        if (s->img) continue;
+        *s = (lcd_sprite_t) {img, x, y, 0, true};
+        return s;
+    }
+    return NULL;
+}
+
+void lcd_sprite_remove(lcd_sprite_t *s) {
+    // the next frame puts back what it covered
+    s->img = NULL;
+}
@@ -0,0 +1,67 @@
+#ifndef LCD_SPRITE_H
+#define LCD_SPRITE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Sprites over a tile map, for screens where things move. A stage is an area of the
+// screen with a background of tiles (or a plain colour) and sprites over it, drawn
+// in the order they were added. Sprites can be changed freely between frames; each
+// lcd_stage_present() sends only what differs from the frame before: where a sprite
+// was and where it is now, and tiles that were replaced. Rectangles cheaper sent
+// together are merged. The render core composites each one a row at a time, straight
+// into the write window, so what a sprite covered comes back from the tile map and
+// nothing has to be saved under it.
+//
+// Images hold frames of w x h panel-order R,G,B pixels, stacked top to bottom, in
+// flash or SRAM, or in PSRAM once lcd_image_to_psram() has copied them there. Pixels
+// of the key colour are left out when a sprite is drawn. A tile set is an image with
+// a tile a frame. See host/bench.c for the sprite counts a frame rate allows.
+
+#define LCD_SPRITE_MAX          32
+#define LCD_STAGE_DIRTY_MAX     48
+#define LCD_IMAGE_OPAQUE        0xFFFFFFFFu     // key of an image with no transparent colour
+#define LCD_TILE_EMPTY          0xFF            // map entry showing the background colour
+
+typedef struct {
+    uint16_t w, h, frames;
+    uint32_t key;               // RGB() colour left out, or LCD_IMAGE_OPAQUE
+    const uint8_t *pixels;      // NULL once the image is in PSRAM
+    uint32_t addr;
+    bool packable;              // all colours but the key pure, so frames go out in 3 bit
+} lcd_image_t;
+
+typedef struct {
+    const lcd_image_t *img;     // NULL: a free slot
+    int x, y, frame;
+    bool visible;
+} lcd_sprite_t;
+
+// frames of w x h pixels from pixels, which must stay put
+extern void lcd_image_init(lcd_image_t *img, int w, int h, int frames, uint32_t key, const uint8_t *pixels);
+// copies the image to PSRAM, after which pixels is no longer needed; false if there
+// is no PSRAM or no room left
+extern bool lcd_image_to_psram(lcd_image_t *img);
+// gives up the PSRAM of every image copied there
+extern void lcd_image_release_all(void);
+
+// x1..y2 inclusive becomes the stage: map (cols tile numbers a row, enough rows to
+// cover the stage) over bg, or just bg when tiles is NULL. Everything is drawn on
+// the next lcd_stage_present().
+extern void lcd_stage_open(int x1, int y1, int x2, int y2, const lcd_image_t *tiles, uint8_t *map, int cols,
+                           uint32_t bg);
+// waits until the last frame is out; sprites are dropped, the screen is left as it is
+extern void lcd_stage_close(void);
+// the map may be in use by the render core, so tiles are changed through this
+extern void lcd_stage_set_tile(int col, int row, uint8_t tile);
+// x1..y2 is drawn again on the next frame, e.g. after something else drew over it
+extern void lcd_stage_invalidate(int x1, int y1, int x2, int y2);
+// sends what changed since the last frame; returns at once, the render core
+// composites and sends while the caller gets on with the next frame
+extern void lcd_stage_present(void);
+
+// a visible sprite of img's frame 0 at x, y; NULL if LCD_SPRITE_MAX are in use
+extern lcd_sprite_t *lcd_sprite_add(const lcd_image_t *img, int x, int y);
+extern void lcd_sprite_remove(lcd_sprite_t *s);
+
+#endif
@@ -0,0 +1,81 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#include "hardware/timer.h"
+
+#include "lcdspi.h"
+#include "lcd_render.h"
+#include "lcd_trace.h"
+
+#if LCD_USE_TRACE
+
+static lcd_trace_event_t ring[LCD_TRACE_LEN];
+static uint32_t count = 0;          // events recorded since the last dump, may exceed the ring
+static uint8_t dc = 0;
+static bool traffic = false;        // bus events since the last frame boundary
+
+// runs from the DMA interrupt too (CS going up at the end of a job), so the slot is
+// taken with interrupts off
+static void record(uint8_t kind, uint32_t len, const uint8_t *d, int n) {
+    uint32_t save = save_and_disable_interrupts();
+    lcd_trace_event_t *e = &ring[count++ % LCD_TRACE_LEN];
+    e->t = time_us_32();
+    e->info = (uint32_t) kind << 24 | (len & 0xFFFFFF);
+    memset(e->d, 0, sizeof(e->d));
+    if (d) memcpy(e->d, d, n);
+    if (kind != LCD_TRACE_FRAME) traffic = true;
+    restore_interrupts(save);
+}
+
+void lcd_trace_dc(bool level) {
+    dc = level ? LCD_TRACE_DC : 0;
+}
+
+void lcd_trace_tx(const uint8_t *p, uint32_t len) {
+    record(LCD_TRACE_TX | dc, len, p, len < 4 ? len : 4);
+}
+
+void lcd_trace_dma(const uint8_t *p, uint32_t len, bool fill) {
+    uint8_t d[4] = {0, 0, 0, fill};
+    memcpy(d, p, len < 3 ? len : 3);
+    record(LCD_TRACE_DMA | dc, len, d, 4);
+}
+
+void lcd_trace_rx(uint32_t len) {
+    record(LCD_TRACE_RX | dc, len, NULL, 0);
+}
+
+void lcd_trace_cs(bool level) {
+    record(LCD_TRACE_CS, 1, &(uint8_t) {level}, 1);
+}
+
+static void frame_call(void *arg) {
+    if (!traffic) return;
+    traffic = false;
+    record(LCD_TRACE_FRAME, 0, NULL, 0);
+}
+
+void lcd_trace_frame(void) {
+    lcd_cmd_t *cmd = lcd_render_cmd(LCD_CMD_CALL);
+    cmd->fn = frame_call;
+    cmd->arg = NULL;
+    lcd_render_submit(cmd);
+}
+
+void lcd_trace_dump(void) {
+    lcd_render_sync();
+    uint32_t first = count > LCD_TRACE_LEN ? count - LCD_TRACE_LEN : 0;
+    printf("lcdtrace 1 %lu %lu\n", (unsigned long) (count - first), (unsigned long) first);
+    for (uint32_t i = first; i < count; i++) {
+        const lcd_trace_event_t *e = &ring[i % LCD_TRACE_LEN];
+        printf("E %08lx %08lx %02x%02x%02x%02x\n", (unsigned long) e->t, (unsigned long) e->info,
+               e->d[0], e->d[1], e->d[2], e->d[3]);
+    }
+    printf("lcdtrace end\n");
+    count = 0;
+    traffic = false;
+}
+
+#endif
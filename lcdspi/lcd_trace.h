@@ -0,0 +1,60 @@
+#ifndef LCD_TRACE_H
+#define LCD_TRACE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "lcdspi.h"
+
+// Bus recorder. With LCD_USE_TRACE set in lcdspi.h every transfer to the panel is
+// logged with a timestamp into a ring of LCD_TRACE_LEN events: bytes sent by the
+// CPU, DMA jobs (logged when queued), readbacks and CS edges. Each transfer carries
+// the DC level it went out with, so commands and parameters can be told apart.
+// lcd_trace_dump() prints the ring over stdio (the UART) as text for
+// tools/lcdtrace.py, which replays it into a model of the panel.
+
+#define LCD_TRACE_LEN   2048    // events, 12 bytes each
+
+enum {
+    LCD_TRACE_TX,       // len bytes from the CPU, d holds the first four
+    LCD_TRACE_DMA,      // len bytes by DMA, d holds the first three, d[3] set for fills
+    LCD_TRACE_RX,       // len bytes read back
+    LCD_TRACE_CS,       // d[0] is the new CS level
+    LCD_TRACE_FRAME,    // frame boundary, from lcd_trace_frame()
+};
+
+#define LCD_TRACE_DC    0x80    // or'ed into the kind: DC was high (data)
+
+typedef struct {
+    uint32_t t;         // time_us_32()
+    uint32_t info;      // kind << 24 | len
+    uint8_t d[4];
+} lcd_trace_event_t;
+
+#if LCD_USE_TRACE
+
+extern void lcd_trace_dc(bool level);
+extern void lcd_trace_tx(const uint8_t *p, uint32_t len);
+extern void lcd_trace_dma(const uint8_t *p, uint32_t len, bool fill);
+extern void lcd_trace_rx(uint32_t len);
+extern void lcd_trace_cs(bool level);
+
+// queues a frame boundary behind everything drawn so far; a boundary with no bus
+// traffic since the last one is not recorded
+extern void lcd_trace_frame(void);
+// prints the ring, oldest event first, and empties it
+extern void lcd_trace_dump(void);
+
+#else
+
+static inline void lcd_trace_dc(bool level) {}
+static inline void lcd_trace_tx(const uint8_t *p, uint32_t len) {}
+static inline void lcd_trace_dma(const uint8_t *p, uint32_t len, bool fill) {}
+static inline void lcd_trace_rx(uint32_t len) {}
+static inline void lcd_trace_cs(bool level) {}
+static inline void lcd_trace_frame(void) {}
+static inline void lcd_trace_dump(void) {}
+
+#endif
+
+#endif
@@ -6,33 +6,47 @@
 #include "hardware/timer.h"
 #include <ctype.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "lcdspi.h"
+#include "lcd_dma.h"
+#include "lcd_shadow.h"
+#include "lcd_psram.h"
+#include "lcd_band.h"
+#include "lcd_scroll.h"
+#include "lcd_render.h"
+#include "lcd_trace.h"
+#include "lcd_glyphs.h"
+#include "lcd_driver.h"
+#include "lcd_console.h"
 #include "i2ckbd.h"
 #include "pico/multicore.h"
 ////////////////////**************************************fonts
 
-#include "fonts/font1.h"
-unsigned char *MainFont = (unsigned char *) font1;
+// the fonts in fonts/ are compiled into the glyph sets of lcd_glyphs.h at build time
 
-#include "fonts/battery.h"
-unsigned char *BatteryFont = (unsigned char *) battery;
-
-static int gui_fcolour;
-static int gui_bcolour;
-static short current_x = 0, current_y = 0; // the current default position for the next char to be written
-static short gui_font_width, gui_font_height;
 static short hres = 0;
 static short vres = 0;
-static char s_height;
-static char s_width;
 int lcd_char_pos = 0;
 unsigned char lcd_buffer[320 * 3] = {0};// 1440 = 480*3, 320*3 = 960
+static unsigned char run_buffer[LCD_WIDTH * 3];
+static unsigned char pack_buffer[2][LCD_WIDTH / 2 + 1];
+static lcd_pixfmt_t pixfmt = LCD_PIXFMT_DEFAULT;
+static bool panel_3bit = false;     // COLMOD currently set to 3 bits per pixel
+static bool window_3bit = false;    // the next write window goes out packed
+lcd_stats_t lcd_stats;
+
+static inline void set_dc(bool level) {
+    gpio_put(Pico_LCD_DC, level);
+    lcd_trace_dc(level);
+}
 
 void __not_in_flash_func(spi_write_fast)(spi_inst_t *spi, const uint8_t *src, size_t len) {
     // Write to TX FIFO whilst ignoring RX, then clean up afterward. When RX
     // is full, PL022 inhibits RX pushes, and sets a sticky flag on
     // push-on-full, but continues shifting. Safe if SSPIMSC_RORIM is not set.
+    lcd_stats.bytes += len;
+    lcd_trace_tx(src, len);
     for (size_t i = 0; i < len; ++i) {
         while (!spi_is_writable(spi))
             tight_loop_contents();
@@ -54,60 +68,186 @@ void __not_in_flash_func(spi_finish)(spi_inst_t *spi) {
     spi_get_hw(spi)->icr = SPI_SSPICR_RORIC_BITS;
 }
 
-void set_font() {
+// the cursor and colours are the console's, see lcd_console.h
+void set_current_y(int y) {
+    int x, old_y;
+    lcd_console_where(&x, &old_y);
+    lcd_console_goto(x, y);
+}
 
-    gui_font_width = MainFont[0];
-    gui_font_height = MainFont[1];
+void set_current_x(int x) {
+    int old_x, y;
+    lcd_console_where(&old_x, &y);
+    lcd_console_goto(x, y);
+}
 
-    s_height = vres / gui_font_height;
-    s_width = hres / gui_font_width;
+void lcd_set_text_color(int fc, int bc) {
+    lcd_console_set_colour(fc, bc);
 }
 
-void set_current_y(int y) {
-    current_y = y;
+void lcd_set_pixel_format(lcd_pixfmt_t fmt) {
+    lcd_render_sync();
+    pixfmt = fmt;
 }
 
-void set_current_x(int x) {
-    current_x = x;
+lcd_pixfmt_t lcd_get_pixel_format(void) {
+    return pixfmt;
 }
 
-void lcd_set_text_color(int fc, int bc) {
-    gui_fcolour = fc;
-    gui_bcolour = bc;
+static inline bool colour_is_3bit(uint32_t c) {
+    uint8_t r = c >> 16, g = (c >> 8) & 0xFF, b = c & 0xFF;
+    return (r == 0 || r == 0xFF) && (g == 0 || g == 0xFF) && (b == 0 || b == 0xFF);
+}
+
+// colour the panel ends up showing when it is sent in 3 bit
+static inline uint32_t colour_3bit(uint32_t c) {
+    return (c & 0x800000 ? 0xFF0000 : 0) | (c & 0x8000 ? 0xFF00 : 0) | (c & 0x80 ? 0xFF : 0);
+}
+
+// a panel-order pixel as the 3 bits the panel takes in 8 colour mode
+static inline uint8_t pack3(const unsigned char *px) {
+    return ((px[0] >> 7) << 2) | ((px[1] >> 7) << 1) | (px[2] >> 7);
+}
+
+// Picks the format of the next write window: `exact` says whether all of its colours
+// survive 3 bit. Windows opened without this go out in 18 bit.
+static bool use_3bit(bool exact) {
+    window_3bit = pixfmt == LCD_PIXFMT_3BIT || (pixfmt == LCD_PIXFMT_AUTO && exact);
+    return window_3bit;
 }
 
 void define_region_spi(int xstart, int ystart, int xend, int yend, int rw) {
     unsigned char coord[4];
+    bool packed = rw && window_3bit;
+    lcd_dma_wait_idle();
+    window_3bit = false;
+    if (packed != panel_3bit) {
+        // COLMOD: the DPI half stays 18 bit, the SPI half is 3 bit or 18 bit
+        spi_write_command(0x3A);
+        spi_write_data(packed ? 0x61 : 0x66);
+        panel_3bit = packed;
+    }
+    lcd_stats.windows++;
+    lcd_stats.commands += 3;
     lcd_spi_lower_cs();
-    gpio_put(Pico_LCD_DC, 0);//gpio_put(Pico_LCD_DC,0);
+    set_dc(0);
     hw_send_spi(&(uint8_t) {ILI9341_COLADDRSET}, 1);
-    gpio_put(Pico_LCD_DC, 1);
+    set_dc(1);
     coord[0] = xstart >> 8;
     coord[1] = xstart;
     coord[2] = xend >> 8;
     coord[3] = xend;
     hw_send_spi(coord, 4);//		HAL_SPI_Transmit(&hspi3,coord,4,500);
-    gpio_put(Pico_LCD_DC, 0);
+    set_dc(0);
     hw_send_spi(&(uint8_t) {ILI9341_PAGEADDRSET}, 1);
-    gpio_put(Pico_LCD_DC, 1);
+    set_dc(1);
     coord[0] = ystart >> 8;
     coord[1] = ystart;
     coord[2] = yend >> 8;
     coord[3] = yend;
     hw_send_spi(coord, 4);//		HAL_SPI_Transmit(&hspi3,coord,4,500);
-    gpio_put(Pico_LCD_DC, 0);
+    set_dc(0);
     if (rw) {
         hw_send_spi(&(uint8_t) {ILI9341_MEMORYWRITE}, 1);
     } else {
         hw_send_spi(&(uint8_t) {ILI9341_RAMRD}, 1);
     }
-    gpio_put(Pico_LCD_DC, 1);
+    set_dc(1);
 }
 
-void read_buffer_spi(int x1, int y1, int x2, int y2, unsigned char *p) {
-    int r, N, t;
-    unsigned char h, l;
-//	PInt(x1);PIntComma(y1);PIntComma(x2);PIntComma(y2);PRet();
+// Window writes are streamed a row at a time: each row is built in one of two
+// scanline buffers and handed to DMA while the next one is prepared. Every row
+// sent is also copied into the PSRAM shadow unless `shadow` is false.
+// Rows are logical; where the scroll area wraps the window is split in two.
+// Rows are always built as panel-order 18 bit pixels and packed on the way out
+// when use_3bit() picked the 8 colour format for the window.
+typedef struct {
+    int x1, x2, y, y2, seg_end, bytes, slot;
+    bool shadow, packed;
+    int carry, first;       // packed: pixel waiting for its partner, first pixel of the window
+    lcd_fence_t fence[2];
+} row_stream_t;
+
+static unsigned char *const stream_buf[2] = {lcd_buffer, run_buffer};
+
+static void stream_window(row_stream_t *rs) {
+    int n = lcd_scroll_run(rs->y), py = lcd_scroll_phys_y(rs->y);
+    if (n > rs->y2 - rs->y + 1) n = rs->y2 - rs->y + 1;
+    rs->seg_end = rs->y + n - 1;
+    rs->carry = rs->first = -1;
+    window_3bit = rs->packed;
+    define_region_spi(rs->x1, py, rs->x2, py + n - 1, 1);
+}
+
+static unsigned char *stream_begin(row_stream_t *rs, int x1, int y1, int x2, int y2, bool shadow) {
+    rs->x1 = x1;
+    rs->x2 = x2;
+    rs->y = y1;
+    rs->y2 = y2;
+    rs->bytes = (x2 - x1 + 1) * 3;
+    rs->slot = 0;
+    rs->shadow = shadow;
+    rs->packed = window_3bit;
+    stream_window(rs);
+    rs->fence[0] = rs->fence[1] = lcd_dma_last_fence();
+    return stream_buf[0];
+}
+
+// Packs a row two pixels a byte. Pixels run on across rows, so an odd one waits for
+// the next row. If one is left when the window ends, the panel's write pointer has
+// wrapped to the window's first pixel, so that pixel is sent again to pad the byte.
+static int stream_pack(row_stream_t *rs, const unsigned char *p, unsigned char *out, bool end) {
+    int n = rs->bytes / 3, i = 0;
+    unsigned char *q = out;
+    if (rs->first < 0) rs->first = pack3(p);
+    if (rs->carry >= 0) {
+        *q++ = (rs->carry << 3) | pack3(p);
+        p += 3;
+        i = 1;
+    }
+    for (; i + 1 < n; i += 2, p += 6) *q++ = (pack3(p) << 3) | pack3(p + 3);
+    rs->carry = i < n ? pack3(p) : -1;
+    if (end && rs->carry >= 0) {
+        *q++ = (rs->carry << 3) | rs->first;
+        rs->carry = -1;
+    }
+    return q - out;
+}
+
+// sends the row just built, returns the buffer for the next one or NULL after the last
+static unsigned char *stream_row(row_stream_t *rs) {
+    unsigned char *p = stream_buf[rs->slot];
+    bool end = rs->y == rs->seg_end;
+    if (rs->packed) {
+        unsigned char *q = pack_buffer[rs->slot];
+        rs->fence[rs->slot] = lcd_dma_send(q, stream_pack(rs, p, q, end), end ? LCD_DMA_END : 0);
+        // the shadow gets what the panel shows
+        if (rs->shadow && pixfmt == LCD_PIXFMT_3BIT)
+            for (int i = 0; i < rs->bytes; i++) p[i] = p[i] & 0x80 ? 0xFF : 0;
+    } else {
+        rs->fence[rs->slot] = lcd_dma_send(p, rs->bytes, end ? LCD_DMA_END : 0);
+    }
+#if LCD_USE_PSRAM_SHADOW
+    if (rs->shadow) lcd_shadow_write(rs->x1, lcd_scroll_phys_y(rs->y), p, rs->bytes / 3);
+#endif
+    if (rs->y == rs->y2) return NULL;
+    if (rs->y++ == rs->seg_end) stream_window(rs);
+    rs->slot ^= 1;
+    lcd_dma_wait(rs->fence[rs->slot]);
+    return stream_buf[rs->slot];
+}
+
+// panel readback gives R,G,B, callers get B,G,R like the pixels draw_buffer_spi() takes
+static void swap_rb(unsigned char *p, int n) {
+    for (unsigned char *end = p + n * 3; p < end; p += 3) {
+        unsigned char h = p[0];
+        p[0] = p[2];
+        p[2] = h;
+    }
+}
+
+static void read_now(int x1, int y1, int x2, int y2, unsigned char *p) {
+    int t;
     // make sure the coordinates are kept within the display area
     if (x2 <= x1) {
         t = x1;
@@ -127,37 +267,84 @@ void read_buffer_spi(int x1, int y1, int x2, int y2, unsigned char *p) {
     if (y1 >= vres) y1 = vres - 1;
     if (y2 < 0) y2 = 0;
     if (y2 >= vres) y2 = vres - 1;
-    N = (x2 - x1 + 1) * (y2 - y1 + 1) * 3;
+    int w = x2 - x1 + 1;
 
-    define_region_spi(x1, y1, x2, y2, 0);
+#if LCD_USE_PSRAM_SHADOW
+    if (lcd_shadow_active()) {
+        for (int y = y1; y <= y2; y++, p += w * 3) {
+            lcd_shadow_read(x1, lcd_scroll_phys_y(y), p, w);
+            swap_rb(p, w);
+        }
+        return;
+    }
+#endif
+    // one readback per stretch of consecutive panel rows
+    for (int y = y1; y <= y2;) {
+        int n = lcd_scroll_run(y), py = lcd_scroll_phys_y(y);
+        if (n > y2 - y + 1) n = y2 - y + 1;
+        define_region_spi(x1, py, x2, py + n - 1, 0);
+        spi_set_baudrate(Pico_LCD_SPI_MOD, LCD_SPI_READ_SPEED);
+        hw_read_spi(p, 1);      // dummy byte
+        hw_read_spi(p, n * w * 3);
+        set_dc(0);
+        lcd_spi_raise_cs();
+        spi_set_baudrate(Pico_LCD_SPI_MOD, LCD_SPI_SPEED);
+        swap_rb(p, n * w);
+        p += n * w * 3;
+        y += n;
+    }
+}
 
-    //spi_init(Pico_LCD_SPI_MOD, 6000000);
-    spi_set_baudrate(Pico_LCD_SPI_MOD, 6000000);
-    //spi_read_data_len(p, 1);
-    hw_read_spi((uint8_t *) p, 1);
-    r = 0;
-    hw_read_spi((uint8_t *) p, N);
-    gpio_put(Pico_LCD_DC, 0);
-    lcd_spi_raise_cs();
-    spi_set_baudrate(Pico_LCD_SPI_MOD, LCD_SPI_SPEED);
-    r = 0;
+// The readback runs on the render core after everything queued before it; p has to
+// stay put until lcd_render_wait() on the fence returned.
+uint32_t read_buffer_spi_async(int x1, int y1, int x2, int y2, unsigned char *p) {
+    lcd_cmd_t *cmd = lcd_render_cmd(LCD_CMD_READ);
+    cmd->x1 = x1;
+    cmd->y1 = y1;
+    cmd->x2 = x2;
+    cmd->y2 = y2;
+    cmd->data = p;
+    lcd_render_submit(cmd);
+    return lcd_render_fence();
+}
 
-    while (N) {
-        h = (uint8_t) p[r + 2];
-        l = (uint8_t) p[r];
-        p[r] = h;//(h & 0xF8);
-        p[r + 2] = l;//(l & 0xF8);
-        r += 3;
-        N -= 3;
+void read_buffer_spi(int x1, int y1, int x2, int y2, unsigned char *p) {
+    lcd_render_wait(read_buffer_spi_async(x1, y1, x2, y2, p));
+}
+
+#if LCD_USE_PSRAM_SHADOW
+// Rectangles kept for later without passing through SRAM more than a row at a time:
+// rows of panel-order bytes, one after the other. Both take a rectangle already
+// clipped to the screen, and the scroll state must not change in between. *packable
+// tells the restore whether every colour survives 3 bit, as blit_now() checks.
+static void save_now(int x1, int y1, int x2, int y2, uint32_t addr, volatile uint8_t *packable) {
+    int w = x2 - x1 + 1;
+    bool pack = true;
+    // run_buffer may still be on its way to the panel
+    lcd_dma_wait_idle();
+    for (int y = y1; y <= y2; y++, addr += w * 3) {
+        lcd_shadow_read(x1, lcd_scroll_phys_y(y), run_buffer, w);
+        lcd_psram_write(addr, run_buffer, w * 3);
+        for (int i = 0; pack && i < w * 3; i++) pack = run_buffer[i] == 0 || run_buffer[i] == 0xFF;
     }
+    *packable = pack;
 }
 
-void draw_buffer_spi(int x1, int y1, int x2, int y2, unsigned char *p) {
-    union colourmap {
-        char rgbbytes[4];
-        unsigned int rgb;
-    } c;
-    unsigned char q[3];
+static void restore_now(int x1, int y1, int x2, int y2, uint32_t addr, const volatile uint8_t *packable) {
+    row_stream_t rs;
+    use_3bit(*packable);
+    unsigned char *q = stream_begin(&rs, x1, y1, x2, y2, true);
+    while (q) {
+        lcd_psram_read(addr, q, rs.bytes);
+        addr += rs.bytes;
+        q = stream_row(&rs);
+    }
+}
+#endif
+
+static void blit_now(int x1, int y1, int x2, int y2, const unsigned char *p) {
+    unsigned char *q;
+    row_stream_t rs;
     int i, t;
     if (x2 <= x1) {
         t = x1;
@@ -177,27 +364,73 @@ void draw_buffer_spi(int x1, int y1, int x2, int y2, unsigned char *p) {
     if (y1 >= vres) y1 = vres - 1;
     if (y2 < 0) y2 = 0;
     if (y2 >= vres) y2 = vres - 1;
-    i = (x2 - x1 + 1) * (y2 - y1 + 1);
-    define_region_spi(x1, y1, x2, y2, 1);
-    while (i--) {
-        c.rgbbytes[0] = *p++; //this order swaps the bytes to match the .BMP file
-        c.rgbbytes[1] = *p++;
-        c.rgbbytes[2] = *p++;
-        // convert the colours to 565 format
-        // convert the colours to 565 format
+    if (pixfmt == LCD_PIXFMT_AUTO) {
+        // only worth packing if nothing in the picture would change colour
+        int n = (x2 - x1 + 1) * (y2 - y1 + 1) * 3;
+        for (i = 0; i < n && (p[i] == 0 || p[i] == 0xFF); i++);
+        use_3bit(i == n);
+    } else use_3bit(false);
+    q = stream_begin(&rs, x1, y1, x2, y2, true);
+    while (q) {
+        //this order swaps the bytes to match the .BMP file
+        for (i = 0; i < rs.bytes; i += 3, p += 3) {
 #ifdef ILI9488
-        q[0] = c.rgbbytes[2];
-        q[1] = c.rgbbytes[1];
-        q[2] = c.rgbbytes[0];
+            q[i] = p[2];
+            q[i + 1] = p[1];
+            q[i + 2] = p[0];
 #endif
-        hw_send_spi(q, 3);
+        }
+        q = stream_row(&rs);
     }
-    lcd_spi_raise_cs();
+}
 
+// Pixels made on the render core as they are sent: row() fills x1..x2 of screen row y
+// with panel-order R,G,B. x1..y2 is on screen. packable says every colour is pure, so
+// the window may go out in 3 bit without looking at the rows first.
+static void rows_now(int x1, int y1, int x2, int y2, const lcd_cmd_t *c) {
+    row_stream_t rs;
+    use_3bit(c->len);
+    unsigned char *q = stream_begin(&rs, x1, y1, x2, y2, true);
+    for (int y = y1; q; y++) {
+        c->row(c->row_arg, x1, x2, y, q);
+        q = stream_row(&rs);
+    }
 }
 
-void draw_bitmap_spi(int x1, int y1, int width, int height, float scale, int fc, int bc, unsigned char *bitmap) {
-    int i, j;
+// Scaled bitmaps sample source column (int) ((x - x1) / scale) and row likewise, in
+// single precision. The columns are worked out once a command into bitmap_col and
+// the row once a screen row, so the pixels themselves take no division: a source bit
+// is found from the row's first bit and the column by shifting. A screen row showing
+// the same source row as the one above it is a copy of that.
+static int16_t bitmap_col[LCD_WIDTH];
+
+static void bitmap_columns(int x0, int x1, int x2, float scale, int width) {
+    for (int x = x1; x <= x2; x++) {
+        int src_x = (int) ((x - x0) / scale);
+        bitmap_col[x - x1] = src_x >= width ? width - 1 : src_x;
+    }
+}
+
+static inline int bitmap_row(int y0, int y, float scale, int height) {
+    int src_y = (int) ((y - y0) / scale);
+    return src_y >= height ? height - 1 : src_y;
+}
+
+// n pixels from source row src_y through bitmap_col, 3 bytes each from f or b
+static unsigned char *bitmap_span(const unsigned char *bitmap, int width, int src_y, int n, const char *f,
+                                  const char *b, unsigned char *q) {
+    uint32_t first = (uint32_t) src_y * width;
+    for (int i = 0; i < n; i++) {
+        uint32_t bit = first + bitmap_col[i];
+        const char *src = (bitmap[bit >> 3] << (bit & 7)) & 0x80 ? f : b;
+        *q++ = src[0];
+        *q++ = src[1];
+        *q++ = src[2];
+    }
+    return q;
+}
+
+static void bitmap_now(int x1, int y1, int width, int height, float scale, int fc, int bc, const unsigned char *bitmap) {
     char f[3], b[3];
     int XStart, XEnd, YEnd, YStart;
     int scaled_width = (int)(width * scale);
@@ -210,6 +443,9 @@ void draw_bitmap_spi(int x1, int y1, int width, int height, float scale, int fc,
     XEnd = (x1 + scaled_width - 1) >= hres ? hres - 1 : (x1 + scaled_width - 1);
     YStart = y1 < 0 ? 0 : y1;
     YEnd = (y1 + scaled_height - 1) >= vres ? vres - 1 : (y1 + scaled_height - 1);
+    if (XEnd < XStart || YEnd < YStart) return;
+    bitmap_columns(x1, XStart, XEnd, scale, width);
+    int n = XEnd - XStart + 1;
 #ifdef ILI9488
     f[0] = (fc >> 16);
     f[1] = (fc >> 8) & 0xFF;
@@ -219,44 +455,51 @@ void draw_bitmap_spi(int x1, int y1, int width, int height, float scale, int fc,
     b[2] = (bc & 0xFF);
 #endif
 
-    define_region_spi(XStart, YStart, XEnd, YEnd, 1);
-
-    for (int y = YStart; y <= YEnd; y++) {
-        int src_y = (int)((y - y1) / scale);
-        if (src_y >= height) src_y = height - 1;
-
-        for (int x = XStart; x <= XEnd; x++) {
-            int src_x = (int)((x - x1) / scale);
-            if (src_x >= width) src_x = width - 1;
-
-            int bit_idx = (src_y * width) + src_x;
-            int byte_idx = bit_idx / 8;
-            int bit_pos = 7 - (bit_idx % 8);
-
-            if ((bitmap[byte_idx] >> bit_pos) & 1) {
-                hw_send_spi((uint8_t *) &f, 3);
-            } else {
-                hw_send_spi((uint8_t *) &b, 3);
-            }
-        }
+    row_stream_t rs;
+    use_3bit(colour_is_3bit(fc) && colour_is_3bit(bc));
+    unsigned char *q = stream_begin(&rs, XStart, YStart, XEnd, YEnd, true), *above = NULL;
+    for (int y = YStart, last = -1; q; y++) {
+        int src_y = bitmap_row(y1, y, scale, height);
+        // the row above is still there, in the other stream buffer
+        if (src_y == last) memcpy(q, above, n * 3);
+        else bitmap_span(bitmap, width, src_y, n, f, b, q);
+        last = src_y;
+        above = q;
+        q = stream_row(&rs);
     }
-    lcd_spi_raise_cs();
 }
 
-void spi_draw_pixel(uint16_t x, uint16_t y, uint32_t color) {
-    if (x >= hres || y >= vres) return;
-    define_region_spi(x, y, x, y, 1);
-    unsigned char col[3];
+// one pixel at panel row py, leaves CS low; col gets the colour the panel shows
+static void send_pixel(int x, int py, uint32_t c, unsigned char *col) {
+    bool packed = use_3bit(colour_is_3bit(c));
+    if (packed) c = colour_3bit(c);
+    define_region_spi(x, py, x, py, 1);
 #ifdef ILI9488
-    col[0] = (color >> 16);
-    col[1] = (color >> 8) & 0xFF;
-    col[2] = (color & 0xFF);
+    col[0] = (c >> 16);
+    col[1] = (c >> 8) & 0xFF;
+    col[2] = (c & 0xFF);
 #endif
-    hw_send_spi(col, 3);
+    if (packed) {
+        // the second half of the byte wraps back onto the same pixel
+        uint8_t v = pack3(col);
+        hw_send_spi(&(uint8_t) {(v << 3) | v}, 1);
+    } else {
+        hw_send_spi(col, 3);
+    }
+}
+
+static void pixel_now(int x, int y, uint32_t color) {
+    if (x < 0 || y < 0 || x >= hres || y >= vres) return;
+    unsigned char col[3];
+    y = lcd_scroll_phys_y(y);
+    send_pixel(x, y, color, col);
     lcd_spi_raise_cs();
+#if LCD_USE_PSRAM_SHADOW
+    lcd_shadow_write(x, y, col, 1);
+#endif
 }
 
-void draw_rect_spi(int x1, int y1, int x2, int y2, int c) {
+static void rect_now(int x1, int y1, int x2, int y2, int c) {
     // convert the colours to 565 format
     unsigned char col[3];
     if (x1 == x2 && y1 == y2) {
@@ -264,16 +507,13 @@ void draw_rect_spi(int x1, int y1, int x2, int y2, int c) {
         if (x1 >= hres) return;
         if (y1 < 0) return;
         if (y1 >= vres) return;
-        define_region_spi(x1, y1, x2, y2, 1);
-#ifdef ILI9488
-        col[0] = (c >> 16);
-        col[1] = (c >> 8) & 0xFF;
-        col[2] = (c & 0xFF);
+        y1 = lcd_scroll_phys_y(y1);
+        send_pixel(x1, y1, c, col);
+#if LCD_USE_PSRAM_SHADOW
+        lcd_shadow_write(x1, y1, col, 1);
 #endif
-        hw_send_spi(col, 3);
     } else {
-        int i, t, y;
-        unsigned char *p;
+        int t;
         // make sure the coordinates are kept within the display area
         if (x2 <= x1) {
             t = x1;
@@ -293,153 +533,819 @@ void draw_rect_spi(int x1, int y1, int x2, int y2, int c) {
         if (y1 >= vres) y1 = vres - 1;
         if (y2 < 0) y2 = 0;
         if (y2 >= vres) y2 = vres - 1;
-        define_region_spi(x1, y1, x2, y2, 1);
-#ifdef ILI9488
-        i = x2 - x1 + 1;
-        i *= 3;
-        p = lcd_buffer;
-        col[0] = (c >> 16);
-        col[1] = (c >> 8) & 0xFF;
-        col[2] = (c & 0xFF);
-        for (t = 0; t < i; t += 3) {
-            p[t] = col[0];
-            p[t + 1] = col[1];
-            p[t + 2] = col[2];
-        }
-        for (y = y1; y <= y2; y++) {
-            spi_write_fast(Pico_LCD_SPI_MOD, p, i);
-        }
+        // the transfer runs on in the background, the next window setup waits for it
+        bool packed = use_3bit(colour_is_3bit(c));
+        if (packed) c = colour_3bit(c);
+        while (y1 <= y2) {
+            int n = lcd_scroll_run(y1), py = lcd_scroll_phys_y(y1);
+            if (n > y2 - y1 + 1) n = y2 - y1 + 1;
+            window_3bit = packed;
+            define_region_spi(x1, py, x2, py + n - 1, 1);
+            if (packed) {
+                // a uniform fill, so a spare half byte at the end lands on a pixel of the same colour
+                uint8_t v = ((c >> 21) & 4) | ((c >> 14) & 2) | ((c >> 7) & 1);
+                lcd_dma_fill_bytes((v << 3) | v, ((x2 - x1 + 1) * n + 1) / 2, LCD_DMA_END);
+            } else {
+                lcd_dma_fill(c, (x2 - x1 + 1) * n, LCD_DMA_END);
+            }
+#if LCD_USE_PSRAM_SHADOW
+            lcd_shadow_fill(x1, py, x2, py + n - 1, c);
 #endif
+            y1 += n;
+        }
+        return;
     }
     spi_finish(Pico_LCD_SPI_MOD);
     lcd_spi_raise_cs();
 }
 
-void lcd_print_char( int fc, int bc, char c, int orientation) {
-    unsigned char *p, *fp, *np = NULL;
-    int modx, mody, scale = 0x01;
-    int height, width;
-
-    // to get the +, - and = chars for font 6 we fudge them by scaling up font 1
-    fp = (unsigned char *) MainFont;
+// Points next to each other along a row or a column share one window.
+static void pixels_now(const lcd_point_t *p, int n, uint32_t c) {
+    for (int i = 0; i < n;) {
+        int j = i + 1;
+        if (p[i].x < 0 || p[i].y < 0 || p[i].x >= hres || p[i].y >= vres) {
+            i = j;
+            continue;
+        }
+        if (j < n && p[j].y == p[i].y && p[j].x == p[i].x + 1) {
+            while (j < n && p[j].y == p[i].y && p[j].x == p[j - 1].x + 1 && p[j].x < hres) j++;
+        } else if (j < n && p[j].x == p[i].x && p[j].y == p[i].y + 1) {
+            while (j < n && p[j].x == p[i].x && p[j].y == p[j - 1].y + 1 && p[j].y < vres) j++;
+        }
+        if (j - i == 1) pixel_now(p[i].x, p[i].y, c);
+        else rect_now(p[i].x, p[i].y, p[j - 1].x, p[j - 1].y, c);
+        i = j;
+    }
+}
 
-    height = fp[1];
-    width = fp[0];
-    modx = mody = 0;
-    //printf("fp %d, c %d ,height %d width %d\n",fp,c, height,width);
+static int clip_code(int x, int y) {
+    return (x < 0) | ((x >= hres) << 1) | ((y < 0) << 2) | ((y >= vres) << 3);
+}
 
-    if (c >= fp[2] && c < fp[2] + fp[3]) {
-        p = fp + 4 + (int) (((c - fp[2]) * height * width) / 8);
-        //printf("p = %d\n",p);
-        np = p;
+// Cohen-Sutherland against the screen, false if nothing is left
+static bool clip_line(int *x1, int *y1, int *x2, int *y2) {
+    int c1 = clip_code(*x1, *y1), c2 = clip_code(*x2, *y2);
+    while (c1 | c2) {
+        if (c1 & c2) return false;
+        int c = c1 ? c1 : c2, x, y;
+        int dx = *x2 - *x1, dy = *y2 - *y1;
+        if (c & 8) {
+            y = vres - 1;
+            x = *x1 + dx * (y - *y1) / dy;
+        } else if (c & 4) {
+            y = 0;
+            x = *x1 + dx * (y - *y1) / dy;
+        } else if (c & 2) {
+            x = hres - 1;
+            y = *y1 + dy * (x - *x1) / dx;
+        } else {
+            x = 0;
+            y = *y1 + dy * (x - *x1) / dx;
+        }
+        if (c == c1) {
+            *x1 = x;
+            *y1 = y;
+            c1 = clip_code(x, y);
+        } else {
+            *x2 = x;
+            *y2 = y;
+            c2 = clip_code(x, y);
+        }
+    }
+    return true;
+}
 
-        draw_bitmap_spi(current_x + modx, current_y + mody, width, height, scale, fc, bc, np);
-    } else {
-        draw_rect_spi(current_x + modx, current_y + mody, current_x + modx + (width * scale),
-                      current_y + mody + (height * scale), bc);
+// Bresenham over the whole line so a clipped line keeps the pixels it would have had
+// on a larger screen; only the visible part is sent, with the pixels on one row
+// (shallow line) or one column (steep line) as a single window
+static void line_now(int x1, int y1, int x2, int y2, int c) {
+    int cx1 = x1, cy1 = y1, cx2 = x2, cy2 = y2;
+    if (!clip_line(&cx1, &cy1, &cx2, &cy2)) return;
+    int dx = abs(x2 - x1), dy = abs(y2 - y1);
+    int sx = x1 < x2 ? 1 : -1, sy = y1 < y2 ? 1 : -1;
+    int err = dx - dy, rx = 0, ry = 0, lx = 0, ly = 0;
+    bool in_run = false, seen = false;
+    for (;;) {
+        bool visible = x1 >= 0 && y1 >= 0 && x1 < hres && y1 < vres;
+        if (!visible && seen) break;   // the screen is convex, so the line does not come back
+        if (visible && !in_run) {
+            rx = x1;
+            ry = y1;
+            in_run = seen = true;
+        }
+        lx = x1;
+        ly = y1;
+        if (x1 == x2 && y1 == y2) break;
+        int e2 = 2 * err, nx = x1, ny = y1;
+        if (e2 > -dy) {
+            err -= dy;
+            nx += sx;
+        }
+        if (e2 < dx) {
+            err += dx;
+            ny += sy;
+        }
+        if (in_run && (dx >= dy ? ny != y1 : nx != x1)) {
+            rect_now(rx, ry, x1, y1, c);
+            in_run = false;
+        }
+        x1 = nx;
+        y1 = ny;
     }
+    if (in_run) rect_now(rx, ry, lx, ly, c);
+}
 
-    if (orientation == ORIENT_NORMAL) current_x += width * scale;
+// The pieces glyph rows are copied from, in the colours of the last text drawn:
+// every nibble as four pixels and a glyph row each of background and foreground.
+static lcd_pen_t pen = {.set = false};
+
+static void pen_set(uint32_t fc, uint32_t bc) {
+    unsigned char f[3], b[3];
+    if (pen.set && pen.fc == fc && pen.bc == bc) return;
+    pen.fc = fc;
+    pen.bc = bc;
+    pen.set = true;
+    f[0] = (fc >> 16);
+    f[1] = (fc >> 8) & 0xFF;
+    f[2] = (fc & 0xFF);
+    b[0] = (bc >> 16);
+    b[1] = (bc >> 8) & 0xFF;
+    b[2] = (bc & 0xFF);
+    for (int i = 0; i < LCD_GLYPHS_MAX_W; i++) {
+        memcpy(pen.fg + i * 3, f, 3);
+        memcpy(pen.bg + i * 3, b, 3);
+    }
+    for (int v = 0; v < 16; v++)
+        for (int i = 0; i < 4; i++) memcpy(pen.nib[v] + i * 3, (v << i) & 8 ? f : b, 3);
+}
 
+// copies columns c0 .. c1 - 1 of a glyph row (NULL: a character the set lacks) to q;
+// whole rows go through the compiled-in instance for the set if there is one
+static unsigned char *glyph_span(const lcd_glyphs_t *g, const uint8_t *row, int c0, int c1, unsigned char *q) {
+    if (!row) {
+        memcpy(q, pen.bg, (c1 - c0) * 3);
+        return q + (c1 - c0) * 3;
+    }
+#if LCD_USE_DRIVER_TEMPLATES
+    static const lcd_glyphs_t *whole_g;
+    static lcd_glyph_row_fn whole;
+    if (g != whole_g) {
+        whole_g = g;
+        whole = lcd_driver_glyph_row(g);
+    }
+    if (whole && c0 == 0 && c1 == g->width) return whole(&pen, row, q);
+#endif
+    if (g->layout == LCD_GLYPHS_NIBBLE) {
+        for (int c = c0; c < c1;) {
+            int k = c >> 2, o = c & 3, n = 4 - o;
+            if (n > c1 - c) n = c1 - c;
+            uint8_t v = k & 1 ? row[k >> 1] & 0x0F : row[k >> 1] >> 4;
+            memcpy(q, pen.nib[v] + o * 3, n * 3);
+            q += n * 3;
+            c += n;
+        }
+        return q;
+    }
+    for (int i = 1, c = 0; i <= row[0] && c < c1; i++) {
+        int from = c > c0 ? c : c0;
+        c += row[i];
+        int to = c < c1 ? c : c1;
+        if (to > from) {
+            memcpy(q, i & 1 ? pen.bg : pen.fg, (to - from) * 3);
+            q += (to - from) * 3;
+        }
+    }
+    return q;
 }
 
-void lcd_print_char_at(int fc, int bc, char c, int orientation, int x, int y) {
-    unsigned char *p, *fp, *np = NULL;
-    int modx, mody, scale = 0x01;
-    int height, width;
+// Renders `len` characters of `s` in glyph set `g` as one run: a single address window
+// covering the whole string, filled scanline by scanline.
+static void text_now(const lcd_glyphs_t *g, int fc, int bc, const char *s, int len, int x, int y) {
+    int width = g->width, height = g->height;
+    int x1 = x, x2 = x + len * width - 1, y1 = y, y2 = y + height - 1;
+    const uint8_t *rows[LCD_CMD_TEXT_MAX];
 
-    fp = (unsigned char *) MainFont;
+    if (len <= 0 || x1 >= hres || y1 >= vres || x2 < 0 || y2 < 0) return;
+    if (x1 < 0) x1 = 0;
+    if (x2 >= hres) x2 = hres - 1;
+    if (y1 < 0) y1 = 0;
+    if (y2 >= vres) y2 = vres - 1;
 
-    height = fp[1];
-    width = fp[0];
-    modx = mody = 0;
+    // every visible character's row at y1
+    int first_char = (x1 - x) / width, first_col = (x1 - x) % width, last_char = (x2 - x) / width;
+    for (int i = first_char; i <= last_char; i++) {
+        int idx = lcd_glyph_index(g, s[i]);
+        rows[i] = idx < 0 ? NULL : lcd_glyph_row0(g, idx);
+        for (int r = y; rows[i] && r < y1; r++) rows[i] = lcd_glyph_next_row(g, rows[i]);
+    }
 
-    if (c >= fp[2] && c < fp[2] + fp[3]) {
-        p = fp + 4 + (int) (((c - fp[2]) * height * width) / 8);
-        np = p;
-        draw_bitmap_spi(x + modx, y + mody, width, height, scale, fc, bc, np);
-    } else {
-        draw_rect_spi(x + modx, y + mody, x + modx + (width * scale),
-                      y + mody + (height * scale), bc);
+
+    row_stream_t rs;
+    pen_set(fc, bc);
+    use_3bit(colour_is_3bit(fc) && colour_is_3bit(bc));
+    unsigned char *p = stream_begin(&rs, x1, y1, x2, y2, true);
+    while (p) {
+        for (int i = first_char, c0 = first_col; i <= last_char; i++, c0 = 0) {
+            int c1 = i == last_char ? (x2 - x) % width + 1 : width;
+            p = glyph_span(g, rows[i], c0, c1, p);
+            if (rows[i]) rows[i] = lcd_glyph_next_row(g, rows[i]);
+        }
+        p = stream_row(&rs);
     }
+}
+
+// Row r of len characters of g as panel-order R,G,B pixels from rgb on, returns the
+// end. For row builders of draw_rows_spi(): it uses the render core's pen, so only
+// there, or while nothing is queued.
+unsigned char *lcd_text_row(const lcd_glyphs_t *g, int fc, int bc, const char *s, int len, int r, unsigned char *rgb) {
+    pen_set(fc, bc);
+    for (int i = 0; i < len; i++) {
+        int idx = lcd_glyph_index(g, s[i]);
+        rgb = glyph_span(g, idx < 0 ? NULL : lcd_glyph_row(g, idx, r), 0, g->width, rgb);
+    }
+    return rgb;
+}
+
+void lcd_print_char_at(int fc, int bc, char c, int orientation, int x, int y) {
+    lcd_print_run(fc, bc, &c, 1, x, y);
     // No update to current_x/current_y
 }
 
 void lcd_print_battery(int c) {
-    unsigned char *p, *fp, *np = NULL;
-    int height, width;
+    // right aligned in the 48 pixels the unscaled symbol took
+    lcd_print_glyphs(&lcd_font_battery, lcd_console_fcolour(), lcd_console_bcolour(), &(char) {'0' + c}, 1,
+                     hres - 48, 0);
+}
+
+// Scrolls the scroll area (see lcd_scroll.h) by moving the panel's start address,
+// only the rows brought into view get drawn
+static void scroll_now(int lines, int bc) {
+    int rows = lcd_scroll_rows();
+    if (lines == 0)return;
+    if (lines >= rows || -lines >= rows) {
+        rect_now(0, 0, hres - 1, rows - 1, bc);
+        return;
+    }
+    lcd_scroll_by(lines);
+    if (lines > 0) rect_now(0, rows - lines, hres - 1, rows - 1, bc); // erase the lines to be scrolled off
+    else rect_now(0, 0, hres - 1, -lines - 1, bc); // erase the lines introduced at the top
+}
+
+#if LCD_USE_BANDS
+// Band compositor, see lcd_band.h. Recorded commands keep the box of the screen they
+// can touch; each band is composited over the part of it they cover, starting from
+// the last rectangle that fills all of that or else from the PSRAM shadow.
+static struct {
+    bool recording;
+    int n, slot;
+    lcd_cmd_t list[LCD_BAND_LIST_MAX];
+    int16_t box[LCD_BAND_LIST_MAX][4];
+    lcd_fence_t fence[2];
+    // the band being composited: x1..y2 of the screen, rows of w pixels in buf
+    int x1, y1, x2, y2, w;
+    unsigned char *buf;
+} band;
+static unsigned char band_buf[2][LCD_WIDTH * LCD_BAND_ROWS * 3];
+static unsigned char band_pack[2][(LCD_WIDTH * LCD_BAND_ROWS + 1) / 2 + 1];
+
+static inline unsigned char *band_at(int x, int y) {
+    return band.buf + ((y - band.y1) * band.w + x - band.x1) * 3;
+}
 
-    fp = (unsigned char *) BatteryFont;
+static void band_fill(int x1, int y1, int x2, int y2, uint32_t c) {
+    if (x1 < band.x1) x1 = band.x1;
+    if (y1 < band.y1) y1 = band.y1;
+    if (x2 > band.x2) x2 = band.x2;
+    if (y2 > band.y2) y2 = band.y2;
+    if (x1 > x2 || y1 > y2) return;
+    unsigned char *row = band_at(x1, y1);
+    for (int x = x1; x <= x2; x++) {
+        row[(x - x1) * 3] = c >> 16;
+        row[(x - x1) * 3 + 1] = (c >> 8) & 0xFF;
+        row[(x - x1) * 3 + 2] = c & 0xFF;
+    }
+    for (int y = y1 + 1; y <= y2; y++) memcpy(band_at(x1, y), row, (x2 - x1 + 1) * 3);
+}
+
+static inline void band_pixel(int x, int y, uint32_t c) {
+    if (x < band.x1 || x > band.x2 || y < band.y1 || y > band.y2) return;
+    unsigned char *p = band_at(x, y);
+    p[0] = c >> 16;
+    p[1] = (c >> 8) & 0xFF;
+    p[2] = c & 0xFF;
+}
+
+// the same pixels line_now() sends
+static void band_line(int x1, int y1, int x2, int y2, uint32_t c) {
+    int dx = abs(x2 - x1), dy = abs(y2 - y1);
+    int sx = x1 < x2 ? 1 : -1, sy = y1 < y2 ? 1 : -1;
+    int err = dx - dy;
+    for (;;) {
+        if ((sy > 0 && y1 > band.y2) || (sy < 0 && y1 < band.y1)) break;
+        band_pixel(x1, y1, c);
+        if (x1 == x2 && y1 == y2) break;
+        int e2 = 2 * err;
+        if (e2 > -dy) {
+            err -= dy;
+            x1 += sx;
+        }
+        if (e2 < dx) {
+            err += dx;
+            y1 += sy;
+        }
+    }
+}
 
-    height = fp[1];
-    width = fp[0];
+static void band_text(const lcd_cmd_t *c, const int16_t *box) {
+    const lcd_glyphs_t *g = c->font;
+    int x1 = box[0] > band.x1 ? box[0] : band.x1, x2 = box[2] < band.x2 ? box[2] : band.x2;
+    int y1 = box[1] > band.y1 ? box[1] : band.y1, y2 = box[3] < band.y2 ? box[3] : band.y2;
+    if (x1 > x2 || y1 > y2) return;
+    pen_set(c->fc, c->bc);
+    for (int i = (x1 - c->x1) / g->width; i <= (x2 - c->x1) / g->width; i++) {
+        int cx = c->x1 + i * g->width;
+        int c0 = (x1 > cx ? x1 : cx) - cx, c1 = (x2 < cx + g->width - 1 ? x2 : cx + g->width - 1) - cx + 1;
+        int idx = lcd_glyph_index(g, c->text[i]);
+        const uint8_t *row = idx < 0 ? NULL : lcd_glyph_row0(g, idx);
+        for (int r = c->y1; row && r < y1; r++) row = lcd_glyph_next_row(g, row);
+        for (int y = y1; y <= y2; y++) {
+            glyph_span(g, row, c0, c1, band_at(cx + c0, y));
+            if (row) row = lcd_glyph_next_row(g, row);
+        }
+    }
+}
 
-    p = fp + 4 + ((c *fp[1]*fp[2])/8);
-    np = p;
+// the same sampling as bitmap_now()
+static void band_bitmap(const lcd_cmd_t *c, const int16_t *box) {
+    int x1 = box[0] > band.x1 ? box[0] : band.x1, x2 = box[2] < band.x2 ? box[2] : band.x2;
+    int y1 = box[1] > band.y1 ? box[1] : band.y1, y2 = box[3] < band.y2 ? box[3] : band.y2;
+    char f[3] = {c->fc >> 16, (c->fc >> 8) & 0xFF, c->fc & 0xFF};
+    char b[3] = {c->bc >> 16, (c->bc >> 8) & 0xFF, c->bc & 0xFF};
+    if (x1 > x2) return;
+    bitmap_columns(c->x1, x1, x2, c->scale, c->x2);
+    for (int y = y1; y <= y2; y++)
+        bitmap_span(c->data, c->x2, bitmap_row(c->y1, y, c->scale, c->y2), x2 - x1 + 1, f, b, band_at(x1, y));
+}
 
-    draw_bitmap_spi(hres - width, 0, width, height, 0.8, gui_fcolour, gui_bcolour, np);
+static void band_draw(const lcd_cmd_t *c, const int16_t *box) {
+    switch (c->op) {
+        case LCD_CMD_RECT:
+            band_fill(box[0], box[1], box[2], box[3], c->fc);
+            break;
+        case LCD_CMD_PIXELS:
+            for (int i = 0; i < c->len; i++) band_pixel(c->pts[i].x, c->pts[i].y, c->fc);
+            break;
+        case LCD_CMD_LINE:
+            band_line(c->x1, c->y1, c->x2, c->y2, c->fc);
+            break;
+        case LCD_CMD_TEXT:
+            band_text(c, box);
+            break;
+        case LCD_CMD_BITMAP:
+            band_bitmap(c, box);
+            break;
+    }
+}
 
+// The screen box a command can touch, clipped the way its *_now function clips;
+// false if it draws nothing
+static bool band_box(const lcd_cmd_t *c, int16_t *box) {
+    int x1 = c->x1, y1 = c->y1, x2 = c->x2, y2 = c->y2, t;
+    switch (c->op) {
+        case LCD_CMD_RECT:
+            if (x1 == x2 && y1 == y2 && (x1 < 0 || y1 < 0 || x1 >= hres || y1 >= vres)) return false;
+            if (x2 < x1) t = x1, x1 = x2, x2 = t;
+            if (y2 < y1) t = y1, y1 = y2, y2 = t;
+            // rect_now() pulls the corners onto the screen
+            x1 = x1 < 0 ? 0 : x1 >= hres ? hres - 1 : x1;
+            x2 = x2 < 0 ? 0 : x2 >= hres ? hres - 1 : x2;
+            y1 = y1 < 0 ? 0 : y1 >= vres ? vres - 1 : y1;
+            y2 = y2 < 0 ? 0 : y2 >= vres ? vres - 1 : y2;
+            break;
+        case LCD_CMD_PIXELS:
+            x1 = y1 = INT16_MAX;
+            x2 = y2 = -1;
+            for (int i = 0; i < c->len; i++) {
+                const lcd_point_t *p = &c->pts[i];
+                if (p->x < 0 || p->y < 0 || p->x >= hres || p->y >= vres) continue;
+                if (p->x < x1) x1 = p->x;
+                if (p->x > x2) x2 = p->x;
+                if (p->y < y1) y1 = p->y;
+                if (p->y > y2) y2 = p->y;
+            }
+            if (x2 < 0) return false;
+            break;
+        case LCD_CMD_LINE:
+            if (!clip_line(&x1, &y1, &x2, &y2)) return false;
+            if (x2 < x1) t = x1, x1 = x2, x2 = t;
+            if (y2 < y1) t = y1, y1 = y2, y2 = t;
+            break;
+        case LCD_CMD_TEXT:
+            x2 = x1 + c->len * c->font->width - 1;
+            y2 = y1 + c->font->height - 1;
+            if (c->len <= 0 || x1 >= hres || y1 >= vres || x2 < 0 || y2 < 0) return false;
+            goto clip;
+        case LCD_CMD_BITMAP:
+            x2 = x1 + (int)(c->x2 * c->scale) - 1;
+            y2 = y1 + (int)(c->y2 * c->scale) - 1;
+            if (x1 >= hres || y1 >= vres || x2 < -1 || y2 < -1) return false;
+        clip:
+            if (x1 < 0) x1 = 0;
+            if (y1 < 0) y1 = 0;
+            if (x2 >= hres) x2 = hres - 1;
+            if (y2 >= vres) y2 = vres - 1;
+            if (x1 > x2 || y1 > y2) return false;
+            break;
+        default:
+            return false;
+    }
+    box[0] = x1;
+    box[1] = y1;
+    box[2] = x2;
+    box[3] = y2;
+    return true;
 }
 
-unsigned char scrollbuff[LCD_WIDTH * 3];
+// Two pixels a byte across the whole window; an odd one at the end is paired with
+// the window's first pixel, which the panel's write pointer has wrapped back to
+static int band_pack_window(const unsigned char *p, int pixels, unsigned char *out) {
+    int i, n = 0;
+    for (i = 0; i + 1 < pixels; i += 2, p += 6) out[n++] = (pack3(p) << 3) | pack3(p + 3);
+    if (i < pixels) out[n++] = (pack3(p) << 3) | pack3(p - i * 3);
+    return n;
+}
 
-void scroll_lcd_spi(int lines) {
-    if (lines == 0)return;
-    if (lines >= 0) {
-        for (int i = 0; i < vres - lines; i++) {
-            read_buffer_spi(0, i + lines, hres - 1, i + lines, scrollbuff);
-            draw_buffer_spi(0, i, hres - 1, i, scrollbuff);
+// sends the composited band, a window for each stretch of consecutive panel rows
+static void band_send(void) {
+    int w = band.w, bytes = w * (band.y2 - band.y1 + 1) * 3, i;
+    for (i = 0; i < bytes && (band.buf[i] == 0 || band.buf[i] == 0xFF); i++);
+    bool packed = use_3bit(i == bytes);
+    unsigned char *pk = band_pack[band.slot];
+    for (int y = band.y1; y <= band.y2;) {
+        int n = lcd_scroll_run(y), py = lcd_scroll_phys_y(y);
+        if (n > band.y2 - y + 1) n = band.y2 - y + 1;
+        unsigned char *src = band_at(band.x1, y);
+        window_3bit = packed;
+        define_region_spi(band.x1, py, band.x2, py + n - 1, 1);
+        if (packed) {
+            int len = band_pack_window(src, w * n, pk);
+            band.fence[band.slot] = lcd_dma_send(pk, len, LCD_DMA_END);
+            pk += len;
+            // the shadow gets what the panel shows
+            if (pixfmt == LCD_PIXFMT_3BIT)
+                for (i = 0; i < w * n * 3; i++) src[i] = src[i] & 0x80 ? 0xFF : 0;
+        } else {
+            band.fence[band.slot] = lcd_dma_send(src, w * n * 3, LCD_DMA_END);
         }
-        draw_rect_spi(0, vres - lines, hres - 1, vres - 1, gui_bcolour); // erase the lines to be scrolled off
-    } else {
-        lines = -lines;
-        for (int i = vres - 1; i >= lines; i--) {
-            read_buffer_spi(0, i - lines, hres - 1, i - lines, scrollbuff);
-            draw_buffer_spi(0, i, hres - 1, i, scrollbuff);
+        for (int r = 0; r < n; r++) lcd_shadow_write(band.x1, py + r, src + r * w * 3, w);
+        y += n;
+    }
+}
+
+// Part of band by .. by + LCD_BAND_ROWS - 1 that the recorded commands touch, and the
+// first command to draw there: everything under the last rectangle covering all of it
+// is overdrawn. False if nothing touches the band.
+static bool band_extent(int by, int *ext, int *first) {
+    int x1 = hres, y1 = by + LCD_BAND_ROWS, x2 = -1, y2 = by - 1;
+    for (int i = 0; i < band.n; i++) {
+        const int16_t *b = band.box[i];
+        if (b[3] < by || b[1] >= by + LCD_BAND_ROWS) continue;
+        if (b[0] < x1) x1 = b[0];
+        if (b[2] > x2) x2 = b[2];
+        if (b[1] < y1) y1 = b[1];
+        if (b[3] > y2) y2 = b[3];
+    }
+    if (x2 < 0) return false;
+    ext[0] = x1;
+    ext[1] = y1 < by ? by : y1;
+    ext[2] = x2;
+    ext[3] = y2 >= by + LCD_BAND_ROWS ? by + LCD_BAND_ROWS - 1 : y2;
+    *first = -1;
+    for (int i = band.n - 1; i >= 0; i--) {
+        const int16_t *b = band.box[i];
+        if (band.list[i].op == LCD_CMD_RECT && b[0] <= ext[0] && b[1] <= ext[1] && b[2] >= ext[2] &&
+            b[3] >= ext[3]) {
+            *first = i;
+            break;
         }
-        draw_rect_spi(0, 0, hres - 1, lines - 1, gui_bcolour); // erase the lines introduced at the top
     }
+    return true;
+}
 
+static bool band_cmd_3bit(const lcd_cmd_t *c) {
+    if (c->op == LCD_CMD_TEXT || c->op == LCD_CMD_BITMAP) return colour_is_3bit(c->fc) && colour_is_3bit(c->bc);
+    return colour_is_3bit(c->fc);
 }
 
-void display_put_c(char c) {
-    // if it is printable and it is going to take us off the right hand end of the screen do a CRLF
-    if (c >= MainFont[2] && c < MainFont[2] + MainFont[3]) {
-        if (current_x + gui_font_width > hres) {
-            display_put_c('\r');
-            display_put_c('\n');
+// Bus bytes, roughly, for drawing the list directly and for compositing it. A band
+// that needs the shadow is taken to go out in 18 bit. One of 3 bit colours over a
+// large fill is cheaper drawn as it comes: the band around it would be 18 bit.
+#define BAND_WINDOW_BYTES 12
+
+static bool band_pays(void) {
+    int direct = 0, banded = 0, ext[4], first;
+    bool auto3 = pixfmt == LCD_PIXFMT_AUTO;
+    for (int i = 0; i < band.n; i++) {
+        const lcd_cmd_t *c = &band.list[i];
+        const int16_t *b = band.box[i];
+        int area = (b[2] - b[0] + 1) * (b[3] - b[1] + 1), windows = 1;
+        if (c->op == LCD_CMD_PIXELS) windows = area = c->len;
+        else if (c->op == LCD_CMD_LINE) windows = (b[2] - b[0] < b[3] - b[1] ? b[2] - b[0] : b[3] - b[1]) + 1;
+        if (c->op == LCD_CMD_LINE) area = (b[2] - b[0] > b[3] - b[1] ? b[2] - b[0] : b[3] - b[1]) + 1;
+        direct += windows * BAND_WINDOW_BYTES + (auto3 && band_cmd_3bit(c) ? area / 2 : area * 3);
+    }
+    for (int by = 0; by < vres; by += LCD_BAND_ROWS) {
+        if (!band_extent(by, ext, &first)) continue;
+        bool packed = auto3 && first >= 0;
+        for (int i = first < 0 ? 0 : first; packed && i < band.n; i++) {
+            const int16_t *b = band.box[i];
+            if (b[3] >= ext[1] && b[1] <= ext[3] && b[2] >= ext[0] && b[0] <= ext[2]) packed = band_cmd_3bit(&band.list[i]);
         }
+        int area = (ext[2] - ext[0] + 1) * (ext[3] - ext[1] + 1);
+        banded += BAND_WINDOW_BYTES + (packed ? area / 2 : area * 3);
     }
+    return pixfmt != LCD_PIXFMT_AUTO || banded < direct;
+}
 
-    // handle the standard control chars
-    switch (c) {
-        case '\b':
-            current_x -= gui_font_width;
-            //if (current_x < 0) current_x = 0;
-            if (current_x < 0) {  //Go to end of previous line
-                current_y -= gui_font_height;                  //Go up one line
-                if (current_y < 0) current_y = 0;
-                current_x = (s_width - 1) * gui_font_width;  //go to last character
-            }
-            return;
-        case '\r':
-            current_x = 0;
-            return;
-        case '\n':
-            current_x = 0;
-            current_y += gui_font_height;
-            if (current_y + gui_font_height >= vres) {
-                scroll_lcd_spi(current_y + gui_font_height - vres);
-                current_y -= (current_y + gui_font_height - vres);
-            }
-            return;
-        case '\t':
-            do {
-                display_put_c(' ');
-            } while ((current_x / gui_font_width) % 2);// 2 3 4 8
-            return;
+// composites and sends everything recorded so far, or draws it as it comes when that
+// is cheaper
+static void band_flush(void) {
+    if (!band.n) return;
+    if (!band_pays()) {
+        band.recording = false;
+        for (int i = 0; i < band.n; i++) lcd_render_exec(&band.list[i]);
+        band.recording = true;
+        band.n = 0;
+        return;
     }
-    lcd_print_char(gui_fcolour, gui_bcolour, c, ORIENT_NORMAL);// print it
+    int ext[4], first;
+    for (int by = 0; by < vres; by += LCD_BAND_ROWS) {
+        if (!band_extent(by, ext, &first)) continue;
+        lcd_dma_wait(band.fence[band.slot]);
+        band.buf = band_buf[band.slot];
+        band.x1 = ext[0];
+        band.y1 = ext[1];
+        band.x2 = ext[2];
+        band.y2 = ext[3];
+        band.w = ext[2] - ext[0] + 1;
+        if (first < 0) {
+            for (int y = band.y1; y <= band.y2; y++)
+                lcd_shadow_read(band.x1, lcd_scroll_phys_y(y), band_at(band.x1, y), band.w);
+        }
+        for (int i = first < 0 ? 0 : first; i < band.n; i++) {
+            const int16_t *b = band.box[i];
+            if (b[3] >= band.y1 && b[1] <= band.y2 && b[2] >= band.x1 && b[0] <= band.x2) band_draw(&band.list[i], b);
+        }
+        band_send();
+        band.slot ^= 1;
+    }
+    band.n = 0;
+}
+
+// while a frame is open: keeps c for the compositor, true unless it has to run now
+static bool band_record(const lcd_cmd_t *c) {
+    switch (c->op) {
+        case LCD_CMD_RECT:
+        case LCD_CMD_PIXELS:
+        case LCD_CMD_LINE:
+        case LCD_CMD_TEXT:
+        case LCD_CMD_BITMAP:
+            if (band.n == LCD_BAND_LIST_MAX) band_flush();
+            if (band_box(c, band.box[band.n])) band.list[band.n++] = *c;
+            return true;
+        case LCD_CMD_BAND_END:
+            band_flush();
+            band.recording = false;
+            return true;
+        default:
+            // anything else sees the panel as drawn so far
+            band_flush();
+            return false;
+    }
+}
+
+static void band_begin_now(void) {
+    // pixels no command covers come from the shadow; without it everything goes direct
+    band.recording = lcd_shadow_active();
+    band.n = 0;
+    band.fence[0] = band.fence[1] = lcd_dma_last_fence();
+}
+#endif
+
+void lcd_render_exec(const lcd_cmd_t *c) {
+#if LCD_USE_BANDS
+    if (band.recording && band_record(c)) return;
+#endif
+    switch (c->op) {
+        case LCD_CMD_RECT:
+            rect_now(c->x1, c->y1, c->x2, c->y2, c->fc);
+            break;
+        case LCD_CMD_PIXELS:
+            pixels_now(c->pts, c->len, c->fc);
+            break;
+        case LCD_CMD_LINE:
+            line_now(c->x1, c->y1, c->x2, c->y2, c->fc);
+            break;
+        case LCD_CMD_TEXT:
+            text_now(c->font, c->fc, c->bc, c->text, c->len, c->x1, c->y1);
+            break;
+        case LCD_CMD_BLIT:
+            blit_now(c->x1, c->y1, c->x2, c->y2, c->data);
+            break;
+        case LCD_CMD_ROWS:
+            rows_now(c->x1, c->y1, c->x2, c->y2, c);
+            break;
+        case LCD_CMD_READ:
+            read_now(c->x1, c->y1, c->x2, c->y2, (unsigned char *) c->data);
+            break;
+#if LCD_USE_PSRAM_SHADOW
+        case LCD_CMD_SAVE:
+            save_now(c->x1, c->y1, c->x2, c->y2, c->addr, c->packable);
+            break;
+        case LCD_CMD_RESTORE:
+            restore_now(c->x1, c->y1, c->x2, c->y2, c->addr, c->packable);
+            break;
+#endif
+        case LCD_CMD_BITMAP:
+            bitmap_now(c->x1, c->y1, c->x2, c->y2, c->scale, c->fc, c->bc, c->data);
+            break;
+        case LCD_CMD_SCROLL:
+            scroll_now(c->x1, c->bc);
+            break;
+        case LCD_CMD_SCROLL_RESET:
+            lcd_scroll_reset();
+            break;
+        case LCD_CMD_CALL:
+            c->fn(c->arg);
+            break;
+#if LCD_USE_BANDS
+        case LCD_CMD_BAND_BEGIN:
+            band_begin_now();
+            break;
+#endif
+    }
+}
+
+// The drawing calls below only queue a command for the render core (lcd_render.h)
+
+void draw_rect_spi(int x1, int y1, int x2, int y2, int c) {
+    lcd_cmd_t *cmd = lcd_render_cmd(LCD_CMD_RECT);
+    cmd->x1 = x1;
+    cmd->y1 = y1;
+    cmd->x2 = x2;
+    cmd->y2 = y2;
+    cmd->fc = c;
+    lcd_render_submit(cmd);
+}
+
+void spi_draw_pixel(uint16_t x, uint16_t y, uint32_t color) {
+    lcd_render_pixel(x, y, color);
+}
+
+void draw_pixels_spi(const lcd_point_t *pts, int n, uint32_t color) {
+    for (int i = 0; i < n; i += LCD_CMD_PIXELS_MAX) {
+        lcd_cmd_t *cmd = lcd_render_cmd(LCD_CMD_PIXELS);
+        cmd->len = n - i < LCD_CMD_PIXELS_MAX ? n - i : LCD_CMD_PIXELS_MAX;
+        cmd->fc = color;
+        memcpy(cmd->pts, pts + i, cmd->len * sizeof(lcd_point_t));
+        lcd_render_submit(cmd);
+    }
+}
+
+// hline and vline are clipped, unlike draw_rect_spi which pulls its corners onto the screen
+void draw_hline(int x1, int x2, int y, int c) {
+    if (y < 0 || y >= vres || (x1 < 0 && x2 < 0) || (x1 >= hres && x2 >= hres)) return;
+    draw_rect_spi(x1, y, x2, y, c);
+}
+
+void draw_vline(int x, int y1, int y2, int c) {
+    if (x < 0 || x >= hres || (y1 < 0 && y2 < 0) || (y1 >= vres && y2 >= vres)) return;
+    draw_rect_spi(x, y1, x, y2, c);
+}
+
+void draw_line_spi(int x1, int y1, int x2, int y2, int c) {
+    lcd_cmd_t *cmd = lcd_render_cmd(LCD_CMD_LINE);
+    cmd->x1 = x1;
+    cmd->y1 = y1;
+    cmd->x2 = x2;
+    cmd->y2 = y2;
+    cmd->fc = c;
+    lcd_render_submit(cmd);
+}
+
+// Returns the width drawn. Strings longer than a command holds go out as several runs.
+int lcd_print_glyphs(const lcd_glyphs_t *g, int fc, int bc, const char *s, int len, int x, int y) {
+    int width = g->width, x1 = x, x2 = x + len * width - 1;
+    if (len <= 0 || x1 >= hres || y >= vres || x2 < 0 || y + g->height <= 0) return 0;
+    for (int i = 0; i < len; i += LCD_CMD_TEXT_MAX) {
+        int n = len - i < LCD_CMD_TEXT_MAX ? len - i : LCD_CMD_TEXT_MAX;
+        lcd_cmd_t *cmd = lcd_render_cmd(LCD_CMD_TEXT);
+        cmd->font = g;
+        cmd->fc = fc;
+        cmd->bc = bc;
+        cmd->x1 = x + i * width;
+        cmd->y1 = y;
+        cmd->len = n;
+        memcpy(cmd->text, s + i, n);
+        lcd_render_submit(cmd);
+    }
+    if (x1 < 0) x1 = 0;
+    if (x2 >= hres) x2 = hres - 1;
+    return x2 - x1 + 1;
+}
+
+int lcd_print_run(int fc, int bc, const char *s, int len, int x, int y) {
+    return lcd_print_glyphs(&lcd_font_main, fc, bc, s, len, x, y);
+}
+
+// waits until the picture has been taken from p
+void draw_buffer_spi(int x1, int y1, int x2, int y2, unsigned char *p) {
+    lcd_cmd_t *cmd = lcd_render_cmd(LCD_CMD_BLIT);
+    cmd->x1 = x1;
+    cmd->y1 = y1;
+    cmd->x2 = x2;
+    cmd->y2 = y2;
+    cmd->data = p;
+    lcd_render_submit(cmd);
+    lcd_render_wait(lcd_render_fence());
+}
+
+// x1..y2 (on screen, x1 <= x2, y1 <= y2) drawn from rows that row(arg, x1, x2, y, rgb)
+// builds on the render core, panel-order R,G,B; packable: all of them pure colours.
+// Whatever row() looks at has to stay put until the returned fence has passed.
+uint32_t draw_rows_spi(int x1, int y1, int x2, int y2, lcd_row_fn row, void *arg, bool packable) {
+    lcd_cmd_t *cmd = lcd_render_cmd(LCD_CMD_ROWS);
+    cmd->x1 = x1;
+    cmd->y1 = y1;
+    cmd->x2 = x2;
+    cmd->y2 = y2;
+    cmd->len = packable;
+    cmd->row = row;
+    cmd->row_arg = arg;
+    lcd_render_submit(cmd);
+    return lcd_render_fence();
+}
+
+#if LCD_USE_PSRAM_SHADOW
+// x1..y2 (on screen, x1 <= x2, y1 <= y2) kept in PSRAM from addr on, w * h * 3 bytes.
+// The render core sets *packable once it has looked at the pixels, so it has to stay
+// put as long as the copy is kept.
+void save_buffer_psram(int x1, int y1, int x2, int y2, uint32_t addr, volatile uint8_t *packable) {
+    lcd_cmd_t *cmd = lcd_render_cmd(LCD_CMD_SAVE);
+    cmd->x1 = x1;
+    cmd->y1 = y1;
+    cmd->x2 = x2;
+    cmd->y2 = y2;
+    cmd->addr = addr;
+    cmd->packable = packable;
+    lcd_render_submit(cmd);
+}
+
+// puts back what save_buffer_psram() kept at addr, as one write window
+void draw_buffer_psram(int x1, int y1, int x2, int y2, uint32_t addr, volatile uint8_t *packable) {
+    lcd_cmd_t *cmd = lcd_render_cmd(LCD_CMD_RESTORE);
+    cmd->x1 = x1;
+    cmd->y1 = y1;
+    cmd->x2 = x2;
+    cmd->y2 = y2;
+    cmd->addr = addr;
+    cmd->packable = packable;
+    lcd_render_submit(cmd);
+}
+#endif
+
+// drawing up to lcd_band_end() is composited in bands, see lcd_band.h
+void lcd_band_begin(void) {
+#if LCD_USE_BANDS
+    lcd_render_submit(lcd_render_cmd(LCD_CMD_BAND_BEGIN));
+#endif
+}
+
+void lcd_band_end(void) {
+#if LCD_USE_BANDS
+    lcd_render_submit(lcd_render_cmd(LCD_CMD_BAND_END));
+#endif
+}
+
+// bitmap is read later on the render core, so it has to stay put (fonts and icons do)
+void draw_bitmap_spi(int x1, int y1, int width, int height, float scale, int fc, int bc, unsigned char *bitmap) {
+    lcd_cmd_t *cmd = lcd_render_cmd(LCD_CMD_BITMAP);
+    cmd->x1 = x1;
+    cmd->y1 = y1;
+    cmd->x2 = width;
+    cmd->y2 = height;
+    cmd->scale = scale;
+    cmd->fc = fc;
+    cmd->bc = bc;
+    cmd->data = bitmap;
+    lcd_render_submit(cmd);
+}
+
+void scroll_lcd_spi(int lines) {
+    lcd_cmd_t *cmd = lcd_render_cmd(LCD_CMD_SCROLL);
+    cmd->x1 = lines;
+    cmd->bc = lcd_console_bcolour();
+    lcd_render_submit(cmd);
 }
 
 char lcd_put_char(char c, int flush) {
@@ -452,23 +1358,25 @@ char lcd_put_char(char c, int flush) {
 }
 
 void lcd_print_string(char *s) {
-    while (*s) {
-        if (s[1])lcd_put_char(*s, 0);
-        else lcd_put_char(*s, 1);
-        s++;
-    }
-    fflush(stdout);
+    lcd_console_puts(s);
 }
 
 void lcd_clear() {
+    lcd_render_submit(lcd_render_cmd(LCD_CMD_SCROLL_RESET));
     draw_rect_spi(0, 0, hres - 1, vres - 1, BLACK);
 }
 
 void lcd_putc(uint8_t devn, uint8_t c) {
-    display_put_c(c);
+    lcd_console_putc(c);
+}
+
+// makes everything drawn so far visible; lcd_getc() does this before every key read
+void lcd_flush() {
+    lcd_render_flush();
 }
 
 int lcd_getc(uint8_t devn) {
+    lcd_flush();
     //i2c keyboard
     int c = read_i2c_kbd();
     return c;
@@ -476,16 +1384,20 @@ int lcd_getc(uint8_t devn) {
 
 unsigned char __not_in_flash_func(hw1_swap_spi)(unsigned char data_out) {
     unsigned char data_in = 0;
+    lcd_dma_wait_idle();
+    lcd_trace_tx(&data_out, 1);
     spi_write_read_blocking(spi1, &data_out, &data_in, 1);
     return data_in;
 }
 
 void hw_read_spi(unsigned char *buff, int cnt) {
+    lcd_trace_rx(cnt);
     spi_read_blocking(Pico_LCD_SPI_MOD, 0xff, buff, cnt);
 }
 
 void hw_send_spi(const unsigned char *buff, int cnt) {
-
+    lcd_stats.bytes += cnt;
+    lcd_trace_tx(buff, cnt);
     spi_write_blocking(Pico_LCD_SPI_MOD, buff, cnt);
 
 }
@@ -653,16 +1565,17 @@ void pico_lcd_init() {
 
 void lcd_spi_raise_cs(void) {
     gpio_put(Pico_LCD_CS, 1);
+    lcd_trace_cs(1);
 }
 
 void lcd_spi_lower_cs(void) {
-
     gpio_put(Pico_LCD_CS, 0);
-
+    lcd_trace_cs(0);
 }
 
 void spi_write_data(unsigned char data) {
-    gpio_put(Pico_LCD_DC, 1);
+    lcd_dma_wait_idle();
+    set_dc(1);
     lcd_spi_lower_cs();
     hw_send_spi(&data, 1);
     lcd_spi_raise_cs();
@@ -674,20 +1587,24 @@ void spi_write_data24(uint32_t data) {
     data_array[1] = (data >> 8) & 0xFF;
     data_array[2] = data & 0xFF;
 
-
-    gpio_put(Pico_LCD_DC, 1); // Data mode
-    gpio_put(Pico_LCD_CS, 0);
+    lcd_dma_wait_idle();
+    lcd_stats.bytes += 3;
+    set_dc(1); // Data mode
+    lcd_spi_lower_cs();
+    lcd_trace_tx(data_array, 3);
     spi_write_blocking(Pico_LCD_SPI_MOD, data_array, 3);
-    gpio_put(Pico_LCD_CS, 1);
+    lcd_spi_raise_cs();
 }
 
 void spi_write_command(unsigned char data) {
-    gpio_put(Pico_LCD_DC, 0);
-    gpio_put(Pico_LCD_CS, 0);
-
+    lcd_dma_wait_idle();
+    lcd_stats.commands++;
+    lcd_stats.bytes++;
+    set_dc(0);
+    lcd_spi_lower_cs();
+    lcd_trace_tx(&data, 1);
     spi_write_blocking(Pico_LCD_SPI_MOD, &data, 1);
-
-    gpio_put(Pico_LCD_CS, 1);
+    lcd_spi_raise_cs();
 }
 
 void spi_write_cd(unsigned char command, int data, ...) {
@@ -729,10 +1646,20 @@ void lcd_spi_init() {
 
 void lcd_init() {
     lcd_spi_init();
+#if !LCD_USE_RENDER_CORE
+    lcd_dma_init();
+#endif
     pico_lcd_init();
+#if LCD_USE_PSRAM_SHADOW
+    lcd_shadow_init();
+#endif
+    lcd_scroll_define(LCD_HEIGHT);
 
-    set_font();
-    gui_fcolour = GREEN;
-    gui_bcolour = BLACK;
+    lcd_console_set_colour(GREEN, BLACK);
+    lcd_console_goto(0, 0);
+#if LCD_USE_RENDER_CORE
+    // from here on core 1 owns the panel and its DMA channel
+    lcd_render_start();
+#endif
 
 }
@@ -2,10 +2,14 @@
 #define LCDSPI_H
 #include "pico/multicore.h"
 #include <hardware/spi.h>
+#include "lcd_queue.h"
+#include "lcd_glyphs.h"
 
 //#define LCD_SPI_SPEED   6000000
 #define LCD_SPI_SPEED   25000000
 //#define LCD_SPI_SPEED 50000000
+// RAMRD has a 150 ns minimum read cycle, readback runs at what the panel allows
+#define LCD_SPI_READ_SPEED  6000000
 
 #define Pico_LCD_SCK 10 //
 #define Pico_LCD_TX  11 // MOSI
@@ -22,6 +26,25 @@
 
 #define PIXFMT_BGR 1
 
+// 1: keep a full-colour copy of the panel in PSRAM (lcd_shadow.c) so pixels can be
+// read back without the slow LCD readback
+#define LCD_USE_PSRAM_SHADOW 1
+// 1: lcd_band_begin() .. lcd_band_end() composites drawing in two SRAM bands (~41KB,
+// lcd_band.h) before it goes to the panel; works from the shadow, so it needs that
+#define LCD_USE_BANDS LCD_USE_PSRAM_SHADOW
+
+// How pixels go over SPI. 18BIT: 3 bytes a pixel. 3BIT: the panel's 8 colour mode, two
+// pixels a byte, other colours are thresholded per channel. AUTO: each write window
+// goes out in 3 bit when all its colours are pure, in 18 bit otherwise.
+typedef enum { LCD_PIXFMT_18BIT, LCD_PIXFMT_3BIT, LCD_PIXFMT_AUTO } lcd_pixfmt_t;
+#define LCD_PIXFMT_DEFAULT LCD_PIXFMT_AUTO
+
+// 1: drawing calls queue commands for a render server on core 1 (lcd_render.c)
+#define LCD_USE_RENDER_CORE 1
+
+// 1: log all panel bus traffic for tools/lcdtrace.py (lcd_trace.c, ~24KB of SRAM)
+#define LCD_USE_TRACE 0
+
 #define TFT_SLPOUT 0x11
 #define TFT_INVOFF 0x20
 #define TFT_INVON 0x21
@@ -43,7 +66,7 @@
 
 #define ORIENT_NORMAL       0
 
-#define RGB(red, green, blue) (unsigned int) (((red & 0b11111111) << 16) | ((green  & 0b11111111) << 8) | (blue & 0b11111111))
+#define RGB(red, green, blue) (unsigned int) ((((red) & 0b11111111) << 16) | (((green) & 0b11111111) << 8) | ((blue) & 0b11111111))
 #define WHITE               RGB(255,  255,  255) //0b1111
 #define YELLOW              RGB(255,  255,    0) //0b1110
 #define LILAC               RGB(255,  128,  255) //0b1101
@@ -100,6 +123,14 @@
 #define TRISCLR             -3
 #define TRISSET             -2
 
+// bus traffic counters, for measuring how much each drawing path costs
+typedef struct {
+    uint32_t windows;   // CASET/PASET/RAMWR address window setups
+    uint32_t commands;  // command bytes (DC low)
+    uint32_t bytes;     // every byte put on the bus, commands included
+} lcd_stats_t;
+extern lcd_stats_t lcd_stats;
+
 extern void __not_in_flash_func(spi_write_fast)(spi_inst_t *spi, const uint8_t *src, size_t len);
 extern void __not_in_flash_func(spi_finish)(spi_inst_t *spi);
 extern void hw_read_spi(unsigned char *buff, int cnt);
@@ -113,8 +144,23 @@ extern void spi_write_command(unsigned char data);
 extern void spi_write_cd(unsigned char command, int data, ...);
 extern void spi_write_data24(uint32_t data);
 
+extern void define_region_spi(int xstart, int ystart, int xend, int yend, int rw);
 extern void spi_draw_pixel(uint16_t x, uint16_t y, uint32_t color) ;
 extern void draw_rect_spi(int x1, int y1, int x2, int y2, int c) ;
+extern void draw_pixels_spi(const lcd_point_t *pts, int n, uint32_t color);
+extern void draw_hline(int x1, int x2, int y, int c);
+extern void draw_vline(int x, int y1, int y2, int c);
+extern void draw_line_spi(int x1, int y1, int x2, int y2, int c);
+extern void draw_buffer_spi(int x1, int y1, int x2, int y2, unsigned char *p);
+typedef void (*lcd_row_fn)(void *arg, int x1, int x2, int y, unsigned char *rgb);
+extern uint32_t draw_rows_spi(int x1, int y1, int x2, int y2, lcd_row_fn row, void *arg, bool packable);
+extern void draw_bitmap_spi(int x1, int y1, int width, int height, float scale, int fc, int bc, unsigned char *bitmap);
+extern void read_buffer_spi(int x1, int y1, int x2, int y2, unsigned char *p);
+extern uint32_t read_buffer_spi_async(int x1, int y1, int x2, int y2, unsigned char *p);
+#if LCD_USE_PSRAM_SHADOW
+extern void save_buffer_psram(int x1, int y1, int x2, int y2, uint32_t addr, volatile uint8_t *packable);
+extern void draw_buffer_psram(int x1, int y1, int x2, int y2, uint32_t addr, volatile uint8_t *packable);
+#endif
 extern void lcd_putc(uint8_t devn, uint8_t c);
 extern int  lcd_getc(uint8_t devn);
 extern void lcd_sleeping(uint8_t devn);
@@ -122,17 +168,26 @@ extern void lcd_sleeping(uint8_t devn);
 extern char lcd_put_char(char c, int flush);
 extern void lcd_print_char_at(int fc, int bc, char c, int orientation, int x, int y);
 extern void lcd_print_string(char* s);
+extern int  lcd_print_run(int fc, int bc, const char *s, int len, int x, int y);
+// the same in any glyph set of lcd_glyphs.h, e.g. lcd_font_digits for a result
+extern int  lcd_print_glyphs(const lcd_glyphs_t *g, int fc, int bc, const char *s, int len, int x, int y);
 
+extern unsigned char *lcd_text_row(const lcd_glyphs_t *g, int fc, int bc, const char *s, int len, int r,
+                                   unsigned char *rgb);
 extern void lcd_print_battery(int c);
 
 extern void lcd_spi_init();
 extern void lcd_init();
 extern void lcd_clear();
+extern void lcd_flush();
+extern void scroll_lcd_spi(int lines);
 extern void reset_controller(void);
 extern void pin_set_bit(int pin, unsigned int offset);
 
 extern void set_current_y(int y);
 extern void set_current_x(int x);
 extern void lcd_set_text_color(int fc, int bc);
+extern void lcd_set_pixel_format(lcd_pixfmt_t fmt);
+extern lcd_pixfmt_t lcd_get_pixel_format(void);
 
 #endif
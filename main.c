@@ -6,6 +6,8 @@
 #include "i2ckbd.h"
 #include "keyboard_definition.h"
 #include "lcdspi.h"
+#include "lcd_trace.h"
+#include "lcd_screenshot.h"
 #include "tinyexpr/tinyexpr.h"
 #include "UI/ui.h"
 #include "pwm_sound/pwm_sound.h"
@@ -16,17 +18,24 @@
 #include "filesystem/vfs.h"
 #include "dirent.h"
 
-#define COYOTE_DIR "/coyote"
+// the screen as it is now, to the next free scr_NNN.bmp
+static void take_screenshot() {
+    char path[64];
+    bool ok = lcd_screenshot_name(COYOTE_DIR, path, sizeof(path)) && lcd_screenshot(path);
+    sound_play(ok ? SND_BEEP : SND_ERROR);
+}
 
 void handle_keyboard() {
     int c = lcd_getc(0);
     if (c == KEY_HOME) { ui_show_mode_menu(); return; }
+    if (c == KEY_BREAK) { take_screenshot(); return; }
     if (ui_get_current_mode() == MODE_TEXT) { text_mode_handle_input(c); return; }
 
     int idx = ui_get_active_tab_idx();
     TabContext* ctx = ui_get_tab_context(idx);
 
     if (c >= KEY_F1 && c <= KEY_F4) { update_active_tab(c - KEY_F1); return; }
+    if (idx == 3 && ui_graph_view_key(c)) return;
 
     switch (c) {
         case KEY_F5: ui_show_menu(); break;
@@ -43,6 +52,7 @@ void handle_keyboard() {
         case KEY_BACKSPACE:
             if (ctx->input_index > 0) {
                 ctx->current_input[--ctx->input_index] = '\0';
+                ui_touch_tab(idx);
                 ui_redraw_input_only();
             }
             break;
@@ -50,6 +60,7 @@ void handle_keyboard() {
             if (c > 0 && c < 128 && ctx->input_index < INPUT_BUFFER_SIZE - 1) {
                 ctx->current_input[ctx->input_index++] = c;
                 ctx->current_input[ctx->input_index] = '\0';
+                ui_touch_tab(idx);
                 ui_redraw_input_only();
             }
     }
@@ -80,5 +91,13 @@ int main() {
         else closedir(dir);
     }
 
-    while (1) { handle_keyboard(); sleep_ms(20); }
+    while (1) {
+        handle_keyboard();
+#if LCD_USE_TRACE
+        // everything drawn for one key is a frame; a 'T' on the UART dumps the capture
+        lcd_trace_frame();
+        if (getchar_timeout_us(0) == 'T') lcd_trace_dump();
+#endif
+        sleep_ms(20);
+    }
 }
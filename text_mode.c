@@ -1,17 +1,22 @@
 #include "text_mode.h"
 #include "lcdspi.h"
+#include "lcd_scroll.h"
+#include "lcd_cells.h"
 #include "keyboard_definition.h"
 #include "UI/ui.h"
+#include "config.h"
 #include <string.h>
 #include <stdio.h>
 
 #define MAX_TEXT_LEN 1024
-#define COYOTE_DIR "/coyote"
 
 static char text_buffer[MAX_TEXT_LEN];
 static int text_len = 0;
 
 void text_mode_redraw() {
+    // no tab bar here, the whole screen scrolls
+    lcd_scroll_define(LCD_HEIGHT);
+    lcd_cells_invalidate();
     lcd_clear();
     set_current_x(0); set_current_y(0);
     lcd_set_text_color(BLACK, WHITE);
@@ -47,12 +52,11 @@ void text_mode_handle_input(int c) {
     char fname[32];
     switch (c) {
         case KEY_F1:
-            if (ui_show_file_menu(COYOTE_DIR, fname, sizeof(fname))) load_file(fname);
-            text_mode_redraw();
+            // the menu puts back what it covered unless a file was picked
+            if (ui_show_file_menu(COYOTE_DIR, fname, sizeof(fname))) { load_file(fname); text_mode_redraw(); }
             break;
         case KEY_F5:
             if (ui_show_save_prompt(fname, sizeof(fname))) save_file(fname);
-            text_mode_redraw();
             break;
         case KEY_F6:
             text_buffer[0] = '\0'; text_len = 0;
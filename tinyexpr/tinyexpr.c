@@ -0,0 +1,51 @@
+/* minimal stand-in for codeplea/tinyexpr, for local builds only */
+#include "tinyexpr.h"
+#include <stdlib.h>
+#include <math.h>
+#include <string.h>
+#include <ctype.h>
+#include <limits.h>
+enum { TE_CONSTANT = 1 };
+typedef double (*f1)(double); typedef double (*f2)(double,double);
+#define NEW(t,n) new_expr(t, n)
+static te_expr *new_expr(int type, int n){ te_expr *e = calloc(1, sizeof(te_expr) + (n>1?n-1:0)*sizeof(void*)); e->type=type; return e;}
+typedef struct { const char *s; const te_variable *v; int nv; int err; } st;
+static double add(double a,double b){return a+b;} static double sub(double a,double b){return a-b;}
+static double mul(double a,double b){return a*b;} static double dv(double a,double b){return a/b;}
+static double neg(double a){return -a;} static double pi(void){return 3.14159265358979323846;} static double ee(void){return 2.71828182845904523536;}
+static double fac(double a){ if(a<0)return NAN; if(a>170)return INFINITY; double r=1; for(int i=2;i<=(int)a;i++) r*=i; return r;}
+static const struct { const char *n; const void *f; int t; } fns[] = {
+ {"abs",fabs,TE_FUNCTION1},{"acos",acos,TE_FUNCTION1},{"asin",asin,TE_FUNCTION1},{"atan",atan,TE_FUNCTION1},{"atan2",atan2,TE_FUNCTION2},
+ {"ceil",ceil,TE_FUNCTION1},{"cos",cos,TE_FUNCTION1},{"cosh",cosh,TE_FUNCTION1},{"e",ee,TE_FUNCTION0},{"exp",exp,TE_FUNCTION1},{"fac",fac,TE_FUNCTION1},
+ {"floor",floor,TE_FUNCTION1},{"ln",log,TE_FUNCTION1},{"log",log10,TE_FUNCTION1},{"log10",log10,TE_FUNCTION1},{"pi",pi,TE_FUNCTION0},{"pow",pow,TE_FUNCTION2},
+ {"sin",sin,TE_FUNCTION1},{"sinh",sinh,TE_FUNCTION1},{"sqrt",sqrt,TE_FUNCTION1},{"tan",tan,TE_FUNCTION1},{"tanh",tanh,TE_FUNCTION1},{0,0,0}};
+static te_expr *expr(st *s);
+static void ws(st *s){ while(isspace((unsigned char)*s->s)) s->s++; }
+static te_expr *fn2(const void *f, te_expr *a, te_expr *b){ te_expr *e=NEW(TE_FUNCTION2|TE_FLAG_PURE,2); e->function=f; e->parameters[0]=a; e->parameters[1]=b; return e;}
+static te_expr *fn1(const void *f, te_expr *a){ te_expr *e=NEW(TE_FUNCTION1|TE_FLAG_PURE,1); e->function=f; e->parameters[0]=a; return e;}
+static te_expr *power(st *s);
+static te_expr *base(st *s){
+ ws(s); const char *p=s->s;
+ if (isdigit((unsigned char)*p) || *p=='.') { te_expr *e=NEW(TE_CONSTANT,1); e->value=strtod(p,(char**)&s->s); return e; }
+ if (isalpha((unsigned char)*p)) { const char *q=p; while(isalnum((unsigned char)*q)||*q=='_') q++; int n=q-p; s->s=q;
+  for(int i=0;i<s->nv;i++) if((int)strlen(s->v[i].name)==n && !strncmp(s->v[i].name,p,n)){ te_expr *e=NEW(TE_VARIABLE,1); e->bound=s->v[i].address; return e;}
+  for(int i=0;fns[i].n;i++) if((int)strlen(fns[i].n)==n && !strncmp(fns[i].n,p,n)){
+    if(fns[i].t==TE_FUNCTION0){ ws(s); if(*s->s=='('){ s->s++; ws(s); if(*s->s!=')'){s->err=1;} else s->s++; } te_expr *e=NEW(TE_FUNCTION0|TE_FLAG_PURE,1); e->function=fns[i].f; return e;}
+    if(fns[i].t==TE_FUNCTION1) return fn1(fns[i].f, power(s));
+    ws(s); if(*s->s!='('){s->err=1;return NEW(TE_CONSTANT,1);} s->s++; te_expr *a=expr(s); ws(s); if(*s->s!=','){s->err=1;return a;} s->s++; te_expr *b=expr(s); ws(s); if(*s->s!=')') s->err=1; else s->s++; return fn2(fns[i].f,a,b);}
+  s->err=1; return NEW(TE_CONSTANT,1); }
+ if (*p=='(') { s->s++; te_expr *e=expr(s); ws(s); if(*s->s!=')') s->err=1; else s->s++; return e; }
+ s->err=1; return NEW(TE_CONSTANT,1);
+}
+static te_expr *power(st *s){ int sign=1; ws(s); while(*s->s=='-'||*s->s=='+'){ if(*s->s=='-') sign=-sign; s->s++; ws(s);} te_expr *b=base(s); return sign<0?fn1(neg,b):b; }
+static te_expr *factor(st *s){ te_expr *r=power(s); ws(s); while(*s->s=='^'){ s->s++; r=fn2(pow,r,power(s)); ws(s);} return r; }
+static te_expr *term(st *s){ te_expr *r=factor(s); ws(s); while(*s->s=='*'||*s->s=='/'||*s->s=='%'){ char c=*s->s++; r=fn2(c=='*'?(void*)mul:c=='/'?(void*)dv:(void*)fmod,r,factor(s)); ws(s);} return r; }
+static te_expr *expr(st *s){ te_expr *r=term(s); ws(s); while(*s->s=='+'||*s->s=='-'){ char c=*s->s++; r=fn2(c=='+'?add:sub,r,term(s)); ws(s);} return r; }
+#define M(e,i) te_eval((const te_expr*)(e)->parameters[i])
+double te_eval(const te_expr *n){ if(!n) return NAN;
+ switch(n->type & 0x1F){ case TE_CONSTANT: return n->value; case TE_VARIABLE: return *n->bound;
+ case TE_FUNCTION0: return ((double(*)(void))n->function)(); case TE_FUNCTION1: return ((f1)n->function)(M(n,0)); case TE_FUNCTION2: return ((f2)n->function)(M(n,0),M(n,1)); default: return NAN; } }
+void te_free(te_expr *n){ if(!n) return; int t=n->type&0x1F; int a = t>=TE_FUNCTION0 ? (t&7) : 0; for(int i=0;i<a;i++) te_free(n->parameters[i]); free(n); }
+te_expr *te_compile(const char *e, const te_variable *v, int nv, int *err){ st s={e,v,nv,0}; te_expr *r=expr(&s); ws(&s); if(s.err||*s.s){ te_free(r); if(err)*err=(int)(s.s-e)+1; return 0;} if(err)*err=0; return r; }
+double te_interp(const char *e, int *err){ te_expr *n=te_compile(e,0,0,err); if(!n) return NAN; double r=te_eval(n); te_free(n); return r; }
+void te_print(const te_expr *n){}
@@ -0,0 +1,156 @@
+#!/usr/bin/env python3
+"""Compiles the 1bpp bitmap fonts in lcdspi/fonts/ into glyph sets for lcd_glyphs.h.
+
+Each set is one source font at one size, scaled here rather than on the device,
+in one of two row layouts the text renderer copies without looking at pixels:
+
+    nibble  every glyph row as ceil(width / 4) nibbles, one bit a pixel, so each
+            nibble picks one of 16 pre-coloured four pixel pieces
+    rle     every glyph row as a count byte then run lengths, background first,
+            so each run is one copy from a row of background or foreground
+
+The source is the C array the fonts have always been kept in: width, height,
+first character, character count, then the glyphs MSB first, row after row.
+
+    tools/fontc.py -o lcd_glyph_sets.h \\
+        --set lcd_font_main=fonts/font1.h,1,nibble \\
+        --set lcd_font_digits=fonts/font1.h,3,rle,0123456789
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+
+MAX_WIDTH = 64      # LCD_GLYPHS_MAX_W
+
+
+def f32(v):
+    return struct.unpack("f", struct.pack("f", v))[0]
+
+
+def load_font(path):
+    with open(path) as f:
+        text = f.read()
+    text = re.sub(r"//[^\n]*|/\*.*?\*/", "", text, flags=re.S)
+    m = re.search(r"\[\s*\]\s*=\s*\{(.*?)\}", text, flags=re.S)
+    if not m:
+        sys.exit(f"fontc: no array in {path}")
+    data = [int(v, 0) for v in re.findall(r"0[xX][0-9a-fA-F]+|\d+", m.group(1))]
+    w, h, first, count = data[:4]
+    size = (w * h + 7) // 8
+    glyphs = []
+    for g in range(count):
+        start = 4 + (g * w * h) // 8
+        bits = data[start:start + size]
+        if len(bits) < size:
+            sys.exit(f"fontc: {path} ends inside glyph {g}")
+        glyphs.append([[(bits[(r * w + c) >> 3] >> (7 - ((r * w + c) & 7))) & 1 for c in range(w)]
+                       for r in range(h)])
+    return w, h, first, glyphs
+
+
+def scale_glyph(rows, w, h, s):
+    # the same nearest neighbour sampling, in single precision, that bitmap_now() does
+    s = f32(s)
+    sw, sh = int(f32(w * s)), int(f32(h * s))
+    out = []
+    for y in range(sh):
+        sy = min(int(f32(y / s)), h - 1)
+        out.append([rows[sy][min(int(f32(x / s)), w - 1)] for x in range(sw)])
+    return sw, sh, out
+
+
+def nibble_rows(rows, w):
+    out = []
+    for r in rows:
+        nib = [sum(r[c + i] << (3 - i) for i in range(4) if c + i < w) for c in range(0, w, 4)]
+        if len(nib) & 1:
+            nib.append(0)
+        out += [nib[i] << 4 | nib[i + 1] for i in range(0, len(nib), 2)]
+    return out
+
+
+def rle_rows(rows, w):
+    out = []
+    for r in rows:
+        runs, colour, n = [], 0, 0
+        for v in r:
+            if v != colour:
+                runs.append(n)
+                colour, n = v, 0
+            n += 1
+        runs.append(n)
+        out += [len(runs)] + runs
+    return out
+
+
+def c_bytes(data, indent="    "):
+    lines = []
+    for i in range(0, len(data), 16):
+        lines.append(indent + ",".join(f"0x{v:02X}" for v in data[i:i + 16]) + ",")
+    return "\n".join(lines)
+
+
+def compile_set(name, path, scale, layout, chars):
+    w, h, first, glyphs = load_font(path)
+    if chars:
+        codes = [ord(c) for c in chars]
+        missing = [chr(c) for c in codes if not first <= c < first + len(glyphs)]
+        if missing:
+            sys.exit(f"fontc: {path} has no glyph for {''.join(missing)!r}")
+        picked = [glyphs[c - first] for c in codes]
+    else:
+        picked = glyphs
+    out, offsets = [], []
+    for rows in picked:
+        sw, sh, rows = scale_glyph(rows, w, h, scale)
+        offsets.append(len(out))
+        out += nibble_rows(rows, sw) if layout == "nibble" else rle_rows(rows, sw)
+    if not 0 < sw <= MAX_WIDTH or not 0 < sh < 256:
+        sys.exit(f"fontc: {name} would be {sw}x{sh}, at most {MAX_WIDTH} pixels wide")
+
+    src = [f"// {name}: {os.path.basename(path)} at {scale:g}, {sw}x{sh}, {layout}, {len(out)} bytes"]
+    src.append(f"static const uint8_t {name}_data[] = {{")
+    src.append(c_bytes(out))
+    src.append("};")
+    offset_ref = "NULL"
+    if layout == "rle":
+        src.append(f"static const uint16_t {name}_offset[] = {{")
+        src += ["    " + ",".join(str(v) for v in offsets[i:i + 16]) + "," for i in range(0, len(offsets), 16)]
+        src.append("};")
+        offset_ref = f"{name}_offset"
+    chars_ref = "NULL"
+    if chars:
+        chars_ref = '"' + "".join(c if c not in '"\\' else "\\" + c for c in chars) + '"'
+    kind = "LCD_GLYPHS_NIBBLE" if layout == "nibble" else "LCD_GLYPHS_RLE"
+    src.append(f"const lcd_glyphs_t {name} = {{{sw}, {sh}, {first if not chars else 0}, {len(picked)}, {kind},")
+    src.append(f"        {chars_ref}, {offset_ref}, {name}_data}};")
+    return "\n".join(src) + "\n"
+
+
+def parse_set(spec):
+    name, _, rest = spec.partition("=")
+    f = rest.split(",", 3)
+    if not name or len(f) < 3 or f[2] not in ("nibble", "rle"):
+        raise argparse.ArgumentTypeError(f"expected NAME=FONT,SCALE,nibble|rle[,CHARS], got {spec!r}")
+    return name, f[0], float(f[1]), f[2], f[3] if len(f) > 3 else None
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("-o", "--output", required=True)
+    ap.add_argument("--set", type=parse_set, action="append", required=True,
+                    metavar="NAME=FONT,SCALE,LAYOUT[,CHARS]")
+    args = ap.parse_args()
+
+    out = ["// Generated by tools/fontc.py, do not edit.", ""]
+    for s in args.set:
+        out.append(compile_set(*s))
+    with open(args.output, "w") as f:
+        f.write("\n".join(out))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,172 @@
+#!/usr/bin/env python3
+"""Replays an LCD bus capture into a model of the ILI9488 and reports what it cost.
+
+The capture is the text lcd_trace_dump() prints over the UART (build with
+LCD_USE_TRACE 1 in lcdspi/lcdspi.h, send 'T' on the serial line). Anything
+outside the "lcdtrace" block is ignored, so a raw terminal log works as input.
+
+Per frame it reports bytes on the bus, address windows, redundant window
+setups (CASET/PASET resending the column or page range already set, or a
+window replaced before any pixel went into it) and overdraw (pixels written
+more than once in the frame).
+
+    tools/lcdtrace.py capture.log [--frames]
+"""
+
+import argparse
+import sys
+
+TX, DMA, RX, CS, FRAME = range(5)
+DC = 0x80
+
+CASET, PASET, RAMWR, RAMRD, COLMOD = 0x2A, 0x2B, 0x2C, 0x2E, 0x3A
+PANEL_W, PANEL_ROWS = 320, 480
+
+
+def parse(lines):
+    events = []
+    inside = False
+    for line in lines:
+        f = line.split()
+        if not f:
+            continue
+        if f[0] == "lcdtrace":
+            inside = f[1] != "end"
+            if inside and int(f[3]):
+                print(f"note: {f[3]} older events were overwritten in the ring", file=sys.stderr)
+            continue
+        if inside and f[0] == "E" and len(f) == 4:
+            info = int(f[2], 16)
+            events.append((int(f[1], 16), info >> 24, info & 0xFFFFFF, bytes.fromhex(f[3])))
+    return events
+
+
+class Frame:
+    def __init__(self):
+        self.bytes = 0
+        self.commands = 0
+        self.windows = 0
+        self.redundant = 0
+        self.written = 0
+        self.overdrawn = 0
+        self.t0 = self.t1 = None
+        self.counts = {}
+
+
+class Panel:
+    """What the controller does with the stream: current command, window and pointer."""
+
+    def __init__(self):
+        self.cmd = None
+        self.params = b""
+        self.col = (0, PANEL_W - 1)
+        self.page = (0, PANEL_ROWS - 1)
+        self.x = self.y = 0
+        self.bpp = 3.0              # bytes per pixel, COLMOD 0x66
+        self.carry = 0.0            # part of a pixel left over from the last transfer
+        self.empty_window = False   # window set up but nothing written into it yet
+
+    def command(self, cmd, fr):
+        fr.commands += 1
+        if cmd in (CASET, PASET) and self.empty_window:
+            # the last window was never used
+            fr.redundant += 1
+            self.empty_window = False
+        self.cmd, self.params = cmd, b""
+        if cmd == RAMWR:
+            fr.windows += 1
+            self.x, self.y = self.col[0], self.page[0]
+            self.empty_window = True
+
+    def data(self, d, n, fr):
+        if self.cmd in (CASET, PASET, COLMOD):
+            self.params += d[:n]
+            if self.cmd == COLMOD and self.params:
+                self.bpp = 0.5 if (self.params[0] & 7) == 1 else 3.0
+            elif len(self.params) >= 4:
+                rng = ((self.params[0] << 8) | self.params[1], (self.params[2] << 8) | self.params[3])
+                old = self.col if self.cmd == CASET else self.page
+                if rng == old:
+                    fr.redundant += 1
+                if self.cmd == CASET:
+                    self.col = rng
+                else:
+                    self.page = rng
+                self.cmd = None
+        elif self.cmd == RAMWR:
+            self.empty_window = False
+            self.carry += n / self.bpp
+            px = int(self.carry)
+            self.carry -= px
+            self.write(px, fr)
+
+    def write(self, px, fr):
+        x0, x1 = self.col
+        y1 = self.page[1]
+        while px > 0 and self.y <= y1:
+            n = min(px, x1 - self.x + 1)
+            for x in range(self.x, self.x + n):
+                k = (x, self.y)
+                c = fr.counts.get(k, 0)
+                if c:
+                    fr.overdrawn += 1
+                fr.counts[k] = c + 1
+            fr.written += n
+            px -= n
+            self.x += n
+            if self.x > x1:
+                self.x = x0
+                self.y += 1
+
+
+def replay(events):
+    frames = [Frame()]
+    panel = Panel()
+    for t, kind, n, d in events:
+        fr = frames[-1]
+        base = kind & ~DC
+        if base == FRAME:
+            frames.append(Frame())
+            continue
+        if fr.t0 is None:
+            fr.t0 = t
+        fr.t1 = t
+        if base in (TX, DMA):
+            fr.bytes += n
+            if kind & DC:
+                panel.data(d, n, fr)
+            else:
+                panel.command(d[0], fr)
+        elif base == RX:
+            fr.bytes += n
+    return [f for f in frames if f.bytes]
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("capture")
+    ap.add_argument("--frames", action="store_true", help="one line per frame")
+    args = ap.parse_args()
+    with open(args.capture, errors="replace") as f:
+        frames = replay(parse(f))
+    if not frames:
+        print("no bus traffic in the capture")
+        return
+    tot = Frame()
+    for i, fr in enumerate(frames):
+        distinct = len(fr.counts)
+        if args.frames:
+            us = (fr.t1 - fr.t0) & 0xFFFFFFFF
+            print(f"frame {i:3}: {fr.bytes:7} bytes {fr.windows:4} windows {fr.redundant:3} redundant "
+                  f"{fr.written:6} px written {distinct:6} distinct {fr.overdrawn:6} overdrawn {us:7} us")
+        for k in ("bytes", "commands", "windows", "redundant", "written", "overdrawn"):
+            setattr(tot, k, getattr(tot, k) + getattr(fr, k))
+    n = len(frames)
+    print(f"{n} frames, {tot.bytes} bytes ({tot.bytes // n} per frame), {tot.commands} commands")
+    print(f"windows {tot.windows}, redundant setups {tot.redundant}")
+    pct = 100.0 * tot.overdrawn / tot.written if tot.written else 0.0
+    print(f"pixels written {tot.written}, overdrawn {tot.overdrawn} ({pct:.1f}%)")
+
+
+if __name__ == "__main__":
+    main()